@@ -12,76 +12,201 @@
  * - Optimized action probability calculations
  */
 
+#include <cstdlib>
 #include <set>
 #include <vector>
 #include "cube.h"
+#include "lookup.h"
+#include "directions.h"
+#include "buckets.h"
+#include "stats.h"
+#include "observables.h"
+#include "moments.h"
 
 
+struct Vector3d {
+	double x, y, z;
+};
 
+// Couplings of the action, see the ACTION comment in Ball.
+struct Couplings {
+	double lambda;
+	double alpha;
+	double epsilon;
+};
     
 
 class Ball {
 private:
-    std::vector< Cube* > cubeMap;
-    std::vector< Face* > faceMap;
-    std::vector< Face* > BoundaryFaces;
-
-    // Reuse heap allocations for cubes/faces to avoid new/delete churn.
-    std::vector<Cube*> freeCubes;
-    std::vector<Face*> freeFaces;
-    // Track allocations for cleanup at program end.
-    std::vector<Cube*> allocatedCubes;
-    std::vector<Face*> allocatedFaces;
+    // All cube/face data lives in slot tables; the maps below only hold slots.
+    CubulationStore store;
+
+    // Dense id -> slot maps; they grow and shrink with the ball (size == next*Id)
+    std::vector< Slot > cubeMap;
+    std::vector< Slot > faceMap;
+    std::vector< Slot > BoundaryFaces;
     
-    int availableCubeIds[AbsMaxCubexId], availableFaceIds[AbsMaxFacexId], availableFaceBIds[AbsMaxFacexId];
     int nextCubeId,nextFaceId,nextFaceBId;
+    bool capacityReported = false;
     
     std::vector<std::pair<int, std::string>> growthChain;
 
+    // Parameters, tuning state and output files of the run this ball belongs to
+    SimulationContext* context;
+
+    // Random stream of this ball, every move draws from it
+    RandomStream rng;
+
+    Cube cubeAt(Slot slot) { return Cube(&store, slot); }
+    Face faceAt(Slot slot) { return Face(&store, slot); }
+
+    // Rejection-free engine state (rejection_free.h)
+    MoveBuckets buckets;
+    bool bucketsValid = false;
+    std::vector<uint32_t> regionMark;
+    uint32_t regionEpoch = 0;
+    std::vector<Slot> regionCubes;
+    std::vector<Slot> regionFaces;
+
+    // Cube coordinates packed by cube id (same order as cubeMap) for the radius kernels
+    std::vector<int32_t> cubeX, cubeY, cubeZ;
+    std::vector<double> radialBuffer; // scratch for writeRadialHistogram
+
+    // Running sums over all cube coordinates, kept up to date by growCube/shrinkCube
+    int64_t sumX = 0, sumY = 0, sumZ = 0, sumSquares = 0;
+    int measureCount = 0; // calls since the last full measurement pass
+
+    // Move statistics (stats.h); all of these are no-ops unless built with MOVE_STATS
+    MoveStats moveStats;
+    MoveRule lastRule = RuleNone; // why the last CheckValid* call refused the move
+    bool lastRotated = false;     // the last CheckValid* call rotated the face
+
+    void noteRule(MoveRule rule) { if constexpr (MoveStatsEnabled) lastRule = rule; }
+    void noteRotated() { if constexpr (MoveStatsEnabled) lastRotated = true; }
+    void countProposal(int move) {
+        if constexpr (MoveStatsEnabled) { moveStats.proposals[move]++; lastRule = RuleNone; lastRotated = false; }
+    }
+    void countChecked(int move, int dNB) {
+        if constexpr (MoveStatsEnabled) {
+            if (lastRotated) moveStats.rotated[move]++;
+            if (dNB == -1) moveStats.rejected[move][lastRule]++;
+        }
+    }
+    void countMetropolis(int move, int dNB, bool accepted) {
+        if constexpr (MoveStatsEnabled) {
+            if (accepted) moveStats.accepted[move][MoveBuckets::classOf(dNB)]++;
+            else moveStats.metropolis[move]++;
+        }
+    }
+
+    void addCoordinate(const Vector3& v) {
+        sumX += v.x; sumY += v.y; sumZ += v.z;
+        sumSquares += static_cast<int64_t>(v.x)*v.x + static_cast<int64_t>(v.y)*v.y + static_cast<int64_t>(v.z)*v.z;
+    }
+    // Set the coordinate of a new cube and record it in the packed arrays and sums
+    void placeCube(Cube cube, const Vector3& v) {
+        cube.setVector(v);
+        const int id = cube.getId();
+        cubeX[id] = v.x; cubeY[id] = v.y; cubeZ[id] = v.z;
+        addCoordinate(v);
+    }
+    void removeCoordinate(const Vector3& v) {
+        sumX -= v.x; sumY -= v.y; sumZ -= v.z;
+        sumSquares -= static_cast<int64_t>(v.x)*v.x + static_cast<int64_t>(v.y)*v.y + static_cast<int64_t>(v.z)*v.z;
+    }
+
+    // A grow adds one cube and at most five faces; refuse it once that would pass maxcubes/maxfaces
+    bool hasCapacity() {
+        const SimulationParams& p = context->params;
+        if (nextCubeId < p.maxcubes && nextFaceId + 5 <= p.maxfaces) return true;
+        if (!capacityReported) {
+            printf("Capacity reached (V = %d, faces = %d): maxcubes %d, maxfaces %d\n", nextCubeId, nextFaceId, p.maxcubes, p.maxfaces);
+            capacityReported = true;
+        }
+        return false;
+    }
+
+    bool isBoundarySlot(Slot face) const {
+        const int bId = store.faceBId[face];
+        return bId >= 0 && bId < nextFaceBId && BoundaryFaces[bId] == face;
+    }
+
 	
 public:
-    Ball() { Initialize(); }
-    ~Ball() {
-        for (Cube* c : allocatedCubes) delete c;
-        for (Face* f : allocatedFaces) delete f;
+    // Couplings of this ball; they start from the values in the run parameters
+    double lambda;
+    double alpha;
+    double epsilon;
+
+    explicit Ball(SimulationContext& ctx) : context(&ctx), rng(ctx.params.seed) {
+        setCouplings(Couplings{ctx.params.lambda, ctx.params.alpha, ctx.params.epsilon});
+        Initialize();
     }
+
+    // Rebuild a ball from a checkpoint written by saveState() instead of growing a new one;
+    // loaded is false (reported) if the file cannot be used, the caller decides what then
+    Ball(SimulationContext& ctx, const std::string& checkpoint, bool& loaded) : context(&ctx), rng(ctx.params.seed) {
+        setCouplings(Couplings{ctx.params.lambda, ctx.params.alpha, ctx.params.epsilon});
+        loaded = loadState(checkpoint);
+    }
+
+    // Warm start: a copy of another ball's cubulation for a new run, see clone.h. The
+    // stream is the seed's long_jump(), so even with the source's seed the copy does
+    // not replay the random numbers that grew the source
+    Ball(SimulationContext& ctx, const Ball& source) : context(&ctx), rng(ctx.params.seed) {
+        setCouplings(Couplings{ctx.params.lambda, ctx.params.alpha, ctx.params.epsilon});
+        rng.long_jump();
+        copyCubulation(source);
+    }
+
+    // Copies only through clone() / copyCubulation(), so none happens by accident
+    Ball(const Ball&) = delete;
+    Ball& operator=(const Ball&) = delete;
+    Ball(Ball&&) = default;
+    Ball& operator=(Ball&&) = default;
+
+    RandomStream& getRNG() { return rng; }
+    const MoveStats& getMoveStats() const { return moveStats; }
+    SimulationContext& getContext() { return *context; }
 	
 	void Initialize();
 	
-    Cube* createCube();
-    Face* createFace();
+    Cube createCube();
+    Face createFace();
 
-    void deleteCube(Cube *cube);
-    void deleteFace(Face * face);
+    void deleteCube(Cube cube);
+    void deleteFace(Face face);
 
     // Optional: Getters for retrieving objects by ID
-    Cube* getCube(int id) const;
-    Face* getFace(int id) const;
-    Face* getBFace(int id) const;
+    Cube getCube(int id);
+    Face getFace(int id);
+    Face getBFace(int id);
     
-    Face * GetBoundaryFace(int bId) { return BoundaryFaces[bId]; }
+    Face GetBoundaryFace(int bId) { return faceAt(BoundaryFaces[bId]); }
     
     int getNextCubeId() { return nextCubeId; }
 	int getNextFaceId() { return nextFaceId; }
 	int getBNextFaceId() { return nextFaceBId; }
 
-	void growCube(Face * BoundaryFace);
-	void shrinkCube(Face* boundaryFace);
+	void growCube(Face BoundaryFace);
+	void shrinkCube(Face boundaryFace);
 	
 	void printCubulation();
 
 	bool performGrow();	
 	bool performShrink();		
 
-	std::vector<int> analyzeGrow(Face* boundaryFace);
+	std::vector<int> analyzeGrow(Face boundaryFace);
 
-	std::pair<int, Face*>  CheckValidGrow(Face* boundaryFace);
-	std::pair<int, Face*>  CheckValidShrink(Face* boundaryFace);
+	std::pair<int, Face>  CheckValidGrow(Face boundaryFace);
+	std::pair<int, Face>  CheckValidShrink(Face boundaryFace);
+	std::pair<int, Face>  CheckValidGrowWalk(Face boundaryFace);
+	std::pair<int, Face>  CheckValidShrinkWalk(Face boundaryFace);
 
-	void AddFaceBoundary(Face * face);
-	void RestoreFaceBoundary(Face * face, Vector3 direction);
+	void AddFaceBoundary(Face face);
+	void RestoreFaceBoundary(Face face, Vector3 direction);
 	
-	void RemoveFaceBoundary(Face * face);
+	void RemoveFaceBoundary(Face face);
 
 	void addGrowthStep(int cubeId, const Vector3& dir) { growthChain.push_back({cubeId, dir.getStr()}); }
 
@@ -98,25 +223,43 @@ public:
 	void printCubeDensity(const char* filename);
 
 
-	void setCubeFaceNeighbor(Cube * cube1, Cube * cube2, Face * face, Vector3 direction);
-	void setNewCubeBFacePair(Cube * cube, Face * face, Vector3 direction);
-	void setFaceFaceAdjacent(Face * face1, Face * face2, Vector3 direction1,Vector3 direction2);
-	void setCubeCubeNeighbor(Cube * cube1, Cube * cube2, Vector3 direction);
+	void setCubeFaceNeighbor(Cube cube1, Cube cube2, Face face, Vector3 direction);
+	void setNewCubeBFacePair(Cube cube, Face face, Vector3 direction);
+	void setFaceFaceAdjacent(Face face1, Face face2, Vector3 direction1,Vector3 direction2);
+	void setCubeCubeNeighbor(Cube cube1, Cube cube2, Vector3 direction);
 
 
-	void unsetCubeFaceNeighbor(Cube * cube1, Cube * cube2, Vector3 direction);
-	void unsetNewCubeBFacePair(Cube * cube, Face * face, Vector3 direction);
-	void unsetFaceFaceAdjacent(Face * face1, Face * face2, Vector3 direction1,Vector3 direction2);
-	void unsetCubeCubeNeighbor(Cube * cube1, Cube * cube2, Vector3 direction);
+	void unsetCubeFaceNeighbor(Cube cube1, Cube cube2, Vector3 direction);
+	void unsetNewCubeBFacePair(Cube cube, Face face, Vector3 direction);
+	void unsetFaceFaceAdjacent(Face face1, Face face2, Vector3 direction1,Vector3 direction2);
+	void unsetCubeCubeNeighbor(Cube cube1, Cube cube2, Vector3 direction);
+
+	// Index versions for the direction-templated kernels (directions.h)
+	void setCubeFaceNeighbor(Cube cube1, Cube cube2, Face face, int axis);
+	void setCubeCubeNeighbor(Cube cube1, Cube cube2, int idx);
+	void setNewCubeBFacePair(Cube cube, Face face, int axis);
+	void setFaceFaceAdjacent(Face face1, Face face2, int axis1, int axis2);
+	void unsetNewCubeBFacePair(Cube cube, Face face, int axis);
+	void unsetCubeCubeNeighbor(Cube cube1, Cube cube2, int idx);
+	void unsetCubeFaceNeighbor(Cube cube1, Cube cube2, int axis);
+
+	// Move kernels for a fixed face direction D (grow_cube.h, shrink_cube.h)
+	template<int D> std::pair<int, Face> CheckValidGrowGrid(Face boundaryFace);
+	template<int D> void growCubeAlong(Face boundaryFace);
+	template<int D> void shrinkCubeAlong(Face boundaryFace);
 
 	
 	void initializeCubicStructure(int N);
+	void initializeFromCoordinates(const std::vector<Vector3>& coords);
 	
 	void validateBoundaryFaces();
 	void validateBoundaryFaceNeighbors();
 	void validateAllCubeFaces();
 	void validateCubeNeighbors();
 	void validateBoundaryCube();
+	void validateLookupTables();
+	void validateMoveBuckets();
+	void validateCoordinateSums();
 	void performAllChecks();
 
 
@@ -138,6 +281,15 @@ public:
 	// The factor is the ratio 
 	//
 	
+	Couplings getCouplings() const { return Couplings{lambda, alpha, epsilon}; }
+	void setCouplings(const Couplings& c) { lambda = c.lambda; alpha = c.alpha; epsilon = c.epsilon; }
+
+	// S of the current configuration at couplings c, the weight is exp(-S)
+	double getAction(const Couplings& c) const {
+		const double dV = static_cast<double>(nextCubeId - context->params.V);
+		return c.alpha*nextFaceBId + c.lambda*nextCubeId + c.epsilon*dV*dV;
+	}
+
 	double GetProbN(double dNB) { 
 		if(dNB == 4) return 5.0;
 		else if(dNB == 2) return 2.;
@@ -146,37 +298,41 @@ public:
 		else return 0.2;
 	}
 	
-	bool getActionDiffGrow(double dNB) {
+	double getMoveProbGrow(double dNB) {
 		// Cache member variables to avoid repeated access
 		const int cachedNextFaceBId = nextFaceBId;
 		const int cachedNextCubeId = nextCubeId;
 		const double cachedAlpha = alpha;
 		const double cachedLambda = lambda;
 		const double cachedEpsilon = epsilon;
-		const int cachedV = V;
+		const int cachedV = context->params.V;
 
 		const double cachedNextFaceBId_d = static_cast<double>(cachedNextFaceBId);
 		const double probA = cachedNextFaceBId_d / (cachedNextFaceBId_d + dNB);
 		const double delta_S = -cachedAlpha*dNB - cachedLambda + cachedEpsilon*static_cast<double>(2*(cachedV-cachedNextCubeId)-1);
 		const double probN = GetProbN(dNB);
 		
-		const double moveprob = probN*probA* std::exp(delta_S);
+		return probN*probA* std::exp(delta_S);
+	}
+
+	bool getActionDiffGrow(double dNB) {
+		const double moveprob = getMoveProbGrow(dNB);
 				
 		if(moveprob > 1) return true;
-		else if(moveprob > uniform_real()) return true;
+		else if(moveprob > uniform_real(rng)) return true;
 			
 		return false;
 	}
 	
 	
-	bool getActionDiffShrink(double dNB) {
+	double getMoveProbShrink(double dNB) {
 		// Cache member variables to avoid repeated access
 		const int cachedNextFaceBId = nextFaceBId;
 		const int cachedNextCubeId = nextCubeId;
 		const double cachedAlpha = alpha;
 		const double cachedLambda = lambda;
 		const double cachedEpsilon = epsilon;
-		const int cachedV = V;
+		const int cachedV = context->params.V;
 		
 		const double cachedNextFaceBId_d = static_cast<double>(cachedNextFaceBId);
 		const double probA = cachedNextFaceBId_d / (cachedNextFaceBId_d + dNB);
@@ -185,21 +341,53 @@ public:
 		
 		const double probN = GetProbN(dNB);
 		
-		const double moveprob = probN*probA*std::exp(delta_S);
+		return probN*probA*std::exp(delta_S);
+	}
+
+	bool getActionDiffShrink(double dNB) {
+		const double moveprob = getMoveProbShrink(dNB);
 
 		if(moveprob > 1) return true;
-		else if(moveprob > uniform_real()) return true;
+		else if(moveprob > uniform_real(rng)) return true;
 
 		
 		return false;
 	}
 	
-	void measure();
+	// Rejection-free (n-fold way) engine, see rejection_free.h
+	void buildMoveBuckets();
+	void classifyMoveFace(Slot face);
+	void collectMoveRegion(Cube center);
+	double getMoveRates(double rates[2][5]);
+	double advanceRejectionFree(int steps);
+
+	Observables measure(); // also returns what it wrote
+	void measure(FILE* out);
+	Observables getObservables();
+
+	// O(1) centroid and sum of squared distances from it (measure.h)
+	Vector3d getCentroid() const;
+	double getR2() const;
+	void rebuildCoordinates();
+	void writeRadialHistogram(FILE* out);
 	
 	void tuneV();
 	void tuneA();
+	bool tuneCouplings();
+	bool holdsTargets();
 	
 	void printConfigs();
+
+	// Binary checkpoint / restart, see checkpoint.h
+	bool saveState(const std::string& filename);
+	bool loadState(const std::string& filename);
+
+	// Renumber slots along a Morton curve for locality, see compact.h
+	void compactStorage();
+
+	// Independent copies of the cubulation, see clone.h
+	Ball clone(SimulationContext& ctx) const;
+	void copyCubulation(const Ball& source);
 };
 
 
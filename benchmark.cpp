@@ -0,0 +1,237 @@
+// Benchmarks of the move kernels and of full sweeps.
+//
+//   benchmark suite [seed] [V | checkpoint ...]
+//       For each size (default 1000 10000 100000) grow and equilibrate a ball
+//       (or load a checkpoint written by saveState) and time CheckValidGrow,
+//       CheckValidShrink, growCube, shrinkCube, measure() and a full thermal
+//       cycle (V Metropolis moves in windows of 10, measure(), tuneV()).
+//   benchmark compact [V] [sweeps] [seed]
+//   benchmark V [sweeps] [seed]
+//       Moves per second on a large equilibrated ball before and after slot
+//       compaction (compact.h). The bare form is the original command line.
+//   benchmark
+//       The suite with seed 1 and the default sizes.
+//
+// Everything is driven by the ball RNG, so a given seed and size always time
+// the same sequence of proposals. Result lines are tab-separated:
+//   bench, kernel, V, proposals, accepted, seconds, proposals/s, accepted/s
+// For CheckValid* "accepted" counts valid proposals; growCube and shrinkCube
+// are timed call by call (the timer overhead is included), every call counts
+// as accepted. For sweeps "accepted" counts moves that changed the volume.
+//
+// Build: g++ -std=c++17 -O3 -pthread benchmark.cpp -I. -o benchmark
+
+#include <chrono>
+#include <cctype>
+#include "globals.h"
+
+using BenchClock = std::chrono::steady_clock;
+
+static double secondsSince(BenchClock::time_point start) {
+	return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+static void report(const char* kernel, int V, long proposals, long accepted, double seconds) {
+	printf("bench\t%s\t%d\t%ld\t%ld\t%.4f\t%.0f\t%.0f\n", kernel, V, proposals, accepted, seconds, proposals / seconds, accepted / seconds);
+	fflush(stdout);
+}
+
+// Metropolis moves as in runSimulation, counting the ones that changed the volume
+static long runMoves(Ball& ball, long moves) {
+	long accepted = 0;
+	for (long k = 0; k < moves; k++) {
+		const int before = ball.getNextCubeId();
+		if (0.5 > uniform_real(ball.getRNG())) ball.performGrow();
+		else ball.performShrink();
+		accepted += ball.getNextCubeId() != before;
+	}
+	return accepted;
+}
+
+static void timeMoves(const char* phase, Ball& ball, long moves) {
+	const auto start = BenchClock::now();
+	const long accepted = runMoves(ball, moves);
+	report(phase, ball.getNextCubeId(), moves, accepted, secondsSince(start));
+}
+
+// Moves in windows of 10 with tuneV() every 100 moves, so the ball settles at the target V
+static void equilibrate(Ball& ball, SimulationContext& context, long moves) {
+	const auto start = BenchClock::now();
+	context.window = 10;
+	long accepted = 0;
+	for (long k = 0; k < moves; k += 100) {
+		double meanV = 0;
+		for (int j = 0; j < 10; j++) {
+			accepted += runMoves(ball, context.window);
+			meanV += ball.getNextCubeId();
+		}
+		context.meanV = meanV;
+		ball.tuneV();
+	}
+	report("equilibrate", ball.getNextCubeId(), (moves + 99) / 100 * 100, accepted, secondsSince(start));
+}
+
+static SimulationParams benchParams(int V, int seed) {
+	SimulationParams params;
+	params.V = V;
+	params.seed = seed;
+	params.A = 3 * V;
+	params.startsize = 1;
+	params.lambda = -0.6;
+	params.alpha = 1.2;
+	params.epsilon = 0.002; // holds the volume near V
+	params.steps = params.thermal = params.sweeps = 0;
+	params.name = "bench";
+	params.maxcubes = std::max(params.maxcubes, 2 * V);
+	params.maxfaces = 5 * params.maxcubes + 1;
+	return params;
+}
+
+static void growTo(Ball& ball, int V) {
+	const auto start = BenchClock::now();
+	const int before = ball.getNextCubeId();
+	long proposals = 0;
+	while (ball.getNextCubeId() < V) { ball.performGrow(); proposals++; }
+	report("grow", ball.getNextCubeId(), proposals, ball.getNextCubeId() - before, secondsSince(start));
+}
+
+
+// CheckValidGrow / CheckValidShrink on random boundary faces, the ball is not changed
+template<typename Check> static void timeCheck(const char* kernel, Ball& ball, long proposals, Check check) {
+	long valid = 0;
+	const auto start = BenchClock::now();
+	for (long k = 0; k < proposals; k++) {
+		valid += check(ball.GetBoundaryFace(uniform_int(ball.getRNG(), ball.getBNextFaceId()))).first != -1;
+	}
+	report(kernel, ball.getNextCubeId(), proposals, valid, secondsSince(start));
+}
+
+// Apply `count` valid moves of one kind, timing only the kernel calls
+template<typename Check, typename Apply> static void timeKernel(const char* kernel, Ball& ball, long count, Check check, Apply apply) {
+	double seconds = 0;
+	long applied = 0;
+	for (long tries = 0; applied < count && tries < 100 * count; tries++) {
+		const std::pair<int, Face> move = check(ball.GetBoundaryFace(uniform_int(ball.getRNG(), ball.getBNextFaceId())));
+		if (move.first == -1) continue;
+		const auto start = BenchClock::now();
+		apply(move.second);
+		seconds += secondsSince(start);
+		applied++;
+	}
+	report(kernel, ball.getNextCubeId(), applied, applied, seconds);
+}
+
+static void runSuite(Ball& ball, SimulationContext& context) {
+	const int V = ball.getNextCubeId();
+	const long proposals = std::max(100000L, 10L * V);
+
+	timeCheck("CheckValidGrow", ball, proposals, [&ball](Face face) { return ball.CheckValidGrow(face); });
+	timeCheck("CheckValidShrink", ball, proposals, [&ball](Face face) { return ball.CheckValidShrink(face); });
+
+	// Grow a tenth of the ball and shrink it back, so the size stays put
+	const long kernelMoves = std::max(100, V / 10);
+	timeKernel("growCube", ball, kernelMoves, [&ball](Face face) { return ball.CheckValidGrow(face); },
+	           [&ball](Face face) { ball.growCube(face); });
+	timeKernel("shrinkCube", ball, kernelMoves, [&ball](Face face) { return ball.CheckValidShrink(face); },
+	           [&ball](Face face) { ball.shrinkCube(face); });
+
+	// Text observables into /dev/null: same work as measure() minus the disk
+	FILE* sink = fopen("/dev/null", "w");
+	if (sink) {
+		const long calls = std::max(20L, 20000000L / V);
+		const auto start = BenchClock::now();
+		for (long k = 0; k < calls; k++) ball.measure(sink);
+		report("measure", ball.getNextCubeId(), calls, calls, secondsSince(start));
+	}
+
+	// Thermal cycles as in runSimulation with steps = V
+	const int cycles = 10;
+	context.window = 10;
+	long accepted = 0;
+	const auto start = BenchClock::now();
+	for (int c = 0; c < cycles; c++) {
+		for (int j = 0; j < V / context.window; j++) {
+			double meanV = 0;
+			for (int k = 0; k < context.window; k++) {
+				const int before = ball.getNextCubeId();
+				if (0.5 > uniform_real(ball.getRNG())) ball.performGrow();
+				else ball.performShrink();
+				accepted += ball.getNextCubeId() != before;
+				meanV += ball.getNextCubeId();
+			}
+			context.meanV = meanV;
+		}
+		if (sink) ball.measure(sink);
+		ball.tuneV();
+	}
+	report("thermalCycle", ball.getNextCubeId(), static_cast<long>(cycles) * (V / context.window) * context.window, accepted, secondsSince(start));
+
+	if (sink) fclose(sink);
+}
+
+static bool isNumber(const char* s) {
+	for (; *s; s++) if (!isdigit(static_cast<unsigned char>(*s))) return false;
+	return true;
+}
+
+static int suite(int argc, char* argv[]) {
+	const int seed = argc > 0 ? atoi(argv[0]) : 1;
+	std::vector<std::string> sizes;
+	for (int i = 1; i < argc; i++) sizes.push_back(argv[i]);
+	if (sizes.empty()) sizes = {"1000", "10000", "100000"};
+
+	printf("# bench\tkernel\tV\tproposals\taccepted\tseconds\tproposals/s\taccepted/s\n");
+	for (const std::string& size : sizes) {
+		if (isNumber(size.c_str())) {
+			const int V = atoi(size.c_str());
+			SimulationContext context(benchParams(V, seed));
+			Ball ball(context);
+			growTo(ball, V);
+			equilibrate(ball, context, 2L * V);
+			runSuite(ball, context);
+		}
+		else {
+			// A checkpoint: its volume is the target of tuneV()
+			SimulationParams params = benchParams(500000, seed); // room for checkpoints up to 10^6 cubes
+			SimulationContext context(params);
+			bool loaded;
+			Ball ball(context, size, loaded);
+			if (!loaded) return 1;
+			context.params.V = ball.getNextCubeId();
+			context.params.A = ball.getBNextFaceId();
+			runSuite(ball, context);
+		}
+	}
+	return 0;
+}
+
+static int compact(int argc, char* argv[]) {
+	SimulationParams params = benchParams(argc > 0 ? atoi(argv[0]) : 100000, argc > 2 ? atoi(argv[2]) : 1);
+	const int sweeps = argc > 1 ? atoi(argv[1]) : 20;
+
+	SimulationContext context(params);
+	Ball ball(context);
+
+	printf("# bench\tphase\tV\tproposals\taccepted\tseconds\tproposals/s\taccepted/s\n");
+	growTo(ball, params.V);
+	equilibrate(ball, context, static_cast<long>(sweeps) * params.V);
+
+	const long moves = 10L * params.V;
+	timeMoves("before", ball, moves);
+
+	const auto start = BenchClock::now();
+	ball.compactStorage();
+	report("compact", ball.getNextCubeId(), ball.getNextCubeId(), ball.getNextCubeId(), secondsSince(start));
+
+	timeMoves("after", ball, moves);
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	const std::string mode = argc > 1 ? argv[1] : "suite";
+	if (mode == "compact") return compact(argc - 2, argv + 2);
+	if (mode == "suite") return suite(argc - 2, argv + 2);
+	if (isNumber(mode.c_str())) return compact(argc - 1, argv + 1); // benchmark V [sweeps] [seed], as before the suite
+	printf("Usage: %s suite [seed] [V | checkpoint ...]\n       %s compact [V] [sweeps] [seed]\n       %s V [sweeps] [seed]\n", argv[0], argv[0], argv[0]);
+	return 1;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef BUCKETS_H
+#define BUCKETS_H
+
+#include <array>
+#include <vector>
+#include "cube.h"
+
+enum MoveType { MoveGrow = 0, MoveShrink = 1 };
+
+// Boundary faces grouped by their cached move class, for the rejection-free
+// engine (rejection_free.h). Class c = 0..4 holds the faces whose grow/shrink
+// is valid and changes the boundary by dNB = 2*c - 4; invalid faces are in no bucket.
+struct MoveBuckets {
+	std::array<std::array<std::vector<Slot>, 5>, 2> faces;
+	std::array<std::vector<int8_t>, 2> faceClass; // per face slot, -1 if in no bucket
+	std::array<std::vector<int>, 2> position;     // index of the face slot in its bucket
+
+	static int classOf(int dNB) { return (dNB + 4) / 2; }
+	static int dNBOf(int cls) { return 2*cls - 4; }
+
+	void clear() {
+		for (int move = 0; move < 2; move++) {
+			for (auto& bucket : faces[move]) bucket.clear();
+			faceClass[move].clear();
+			position[move].clear();
+		}
+	}
+
+	int count(int move, int cls) const { return static_cast<int>(faces[move][cls].size()); }
+
+	int getClass(int move, Slot face) const {
+		return face < faceClass[move].size() ? faceClass[move][face] : -1;
+	}
+
+	// Move a face slot to bucket cls (-1 removes it), O(1) by swap-with-last.
+	void set(int move, Slot face, int cls) {
+		if (face >= faceClass[move].size()) {
+			faceClass[move].resize(face + 1, -1);
+			position[move].resize(face + 1, -1);
+		}
+
+		const int old = faceClass[move][face];
+		if (old == cls) return;
+
+		if (old >= 0) {
+			std::vector<Slot>& bucket = faces[move][old];
+			const int pos = position[move][face];
+			bucket[pos] = bucket.back();
+			position[move][bucket[pos]] = pos;
+			bucket.pop_back();
+		}
+		if (cls >= 0) {
+			position[move][face] = static_cast<int>(faces[move][cls].size());
+			faces[move][cls].push_back(face);
+		}
+		faceClass[move][face] = static_cast<int8_t>(cls);
+	}
+
+	// Face slots were renumbered (compact.h): old slot s is now remap[s]. Bucket order is kept.
+	void remap(const std::vector<Slot>& remap) {
+		for (int move = 0; move < 2; move++) {
+			faceClass[move].assign(remap.size(), -1);
+			position[move].assign(remap.size(), -1);
+			for (int cls = 0; cls < 5; cls++) {
+				std::vector<Slot>& bucket = faces[move][cls];
+				for (size_t i = 0; i < bucket.size(); i++) {
+					bucket[i] = remap[bucket[i]];
+					faceClass[move][bucket[i]] = static_cast<int8_t>(cls);
+					position[move][bucket[i]] = static_cast<int>(i);
+				}
+			}
+		}
+	}
+};
+
+#endif
@@ -1,4 +1,4 @@
-g++ -g main.cpp -I. -std=c++17 -O3 -o Cb
+g++ -g main.cpp -I. -std=c++17 -O3 -pthread -o Cb
 
 #valgrind --leak-check=full --track-origins=yes -v ./Cb
 
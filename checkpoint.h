@@ -0,0 +1,188 @@
+#pragma once
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+/*
+ * Binary checkpoint of a whole ball.
+ *
+ * Layout (native byte order):
+ *   header   : magic "CUBS", format version, thermal cycles completed
+ *   tuning   : adaptive tuning state (TuneState)
+ *   couplings: lambda, alpha, epsilon
+ *   rng      : the ball's RandomStream (generator state and unread buffer)
+ *   counters : nextCubeId, nextFaceId, nextFaceBId
+ *   maps     : cubeMap, faceMap, BoundaryFaces (live prefix only, in order)
+ *   store    : every CubulationStore table, including the free slot lists
+ *
+ * Only files of the current version are loaded.
+ *
+ * Each table is a 64-bit element count followed by the raw elements. The slot
+ * tables and free lists are restored exactly, so a restarted Metropolis run
+ * continues as if it had never stopped. The rejection-free buckets are not
+ * saved; they are rebuilt on the first step after loading.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include "ball.h"
+
+static constexpr char CheckpointMagic[4] = {'C', 'U', 'B', 'S'};
+static constexpr uint32_t CheckpointVersion = 1;
+
+template<typename T> static inline bool writePod(FILE* f, const T& value) {
+	static_assert(std::is_trivially_copyable<T>::value, "checkpoint fields must be plain data");
+	return fwrite(&value, sizeof(T), 1, f) == 1;
+}
+
+template<typename T> static inline bool readPod(FILE* f, T& value) {
+	static_assert(std::is_trivially_copyable<T>::value, "checkpoint fields must be plain data");
+	return fread(&value, sizeof(T), 1, f) == 1;
+}
+
+template<typename T> static inline bool writeTable(FILE* f, const T* data, uint64_t count) {
+	return writePod(f, count) && (count == 0 || fwrite(data, sizeof(T), count, f) == count);
+}
+
+template<typename T, typename A> static inline bool writeTable(FILE* f, const std::vector<T, A>& table) {
+	return writeTable(f, table.data(), table.size());
+}
+
+template<typename T, typename A> static inline bool readTable(FILE* f, std::vector<T, A>& table, uint64_t maxCount) {
+	uint64_t count;
+	if (!readPod(f, count) || count > maxCount) return false;
+	table.resize(count);
+	return count == 0 || fread(table.data(), sizeof(T), count, f) == count;
+}
+
+// Every link in the rows points at a slot below count or is NoSlot
+template<typename Table> static inline bool linksInRange(const Table& table, size_t count) {
+	for (const auto& row : table) {
+		for (Slot s : row) if (s != NoSlot && s >= count) return false;
+	}
+	return true;
+}
+
+
+bool Ball::saveState(const std::string& filename) {
+	// Write next to the old checkpoint and swap at the end, so a kill during the write keeps it intact
+	const std::string tmpname = filename + ".tmp";
+	FILE* f = fopen(tmpname.c_str(), "wb");
+	if (!f) {
+		perror("Failed to open checkpoint for writing");
+		return false;
+	}
+
+	const int32_t cycle = context->cycle;
+	bool ok = fwrite(CheckpointMagic, 1, 4, f) == 4
+	       && writePod(f, CheckpointVersion) && writePod(f, cycle) && writePod(f, context->tune)
+	       && writePod(f, getCouplings()) && writePod(f, rng)
+	       && writePod(f, nextCubeId) && writePod(f, nextFaceId) && writePod(f, nextFaceBId)
+	       && writeTable(f, cubeMap.data(), nextCubeId)
+	       && writeTable(f, faceMap.data(), nextFaceId)
+	       && writeTable(f, BoundaryFaces.data(), nextFaceBId)
+	       && writeTable(f, store.cubeId) && writeTable(f, store.cubeCoord) && writeTable(f, store.cubeFaces)
+	       && writeTable(f, store.cubeNeighbors) && writeTable(f, store.cubeMask)
+	       && writeTable(f, store.faceId) && writeTable(f, store.faceBId) && writeTable(f, store.faceCoord)
+	       && writeTable(f, store.faceCubes) && writeTable(f, store.faceNeighbors) && writeTable(f, store.faceCubeCount)
+	       && writeTable(f, store.freeCubeSlots) && writeTable(f, store.freeFaceSlots);
+
+	ok = (fclose(f) == 0) && ok;
+	ok = ok && std::rename(tmpname.c_str(), filename.c_str()) == 0;
+	if (!ok) perror("Failed to write checkpoint");
+	return ok;
+}
+
+
+bool Ball::loadState(const std::string& filename) {
+	FILE* f = fopen(filename.c_str(), "rb");
+	if (!f) {
+		perror("Failed to open checkpoint");
+		return false;
+	}
+
+	char magic[4];
+	uint32_t version = 0;
+	int32_t cycle = 0;
+	TuneState tune;
+	Couplings couplings;
+	RandomStream stream;
+	int cubes = 0, faces = 0, boundaryFaces = 0;
+	std::vector<Slot> cubeSlots, faceSlots, boundarySlots;
+	CubulationStore loaded;
+	// The ball must fit this run's capacity (the slot tables never hold more than the peak size)
+	const int maxCubes = context->params.maxcubes, maxFaces = context->params.maxfaces;
+
+	bool ok = fread(magic, 1, 4, f) == 4 && std::equal(magic, magic + 4, CheckpointMagic)
+	       && readPod(f, version) && version == CheckpointVersion && readPod(f, cycle) && readPod(f, tune)
+	       && readPod(f, couplings) && readPod(f, stream)
+	       && readPod(f, cubes) && readPod(f, faces) && readPod(f, boundaryFaces)
+	       && cubes >= 0 && cubes <= maxCubes && faces >= 0 && faces <= maxFaces
+	       && boundaryFaces >= 0 && boundaryFaces <= maxFaces
+	       && readTable(f, cubeSlots, cubes) && readTable(f, faceSlots, faces) && readTable(f, boundarySlots, boundaryFaces)
+	       && readTable(f, loaded.cubeId, maxCubes) && readTable(f, loaded.cubeCoord, maxCubes)
+	       && readTable(f, loaded.cubeFaces, maxCubes) && readTable(f, loaded.cubeNeighbors, maxCubes)
+	       && readTable(f, loaded.cubeMask, maxCubes)
+	       && readTable(f, loaded.faceId, maxFaces) && readTable(f, loaded.faceBId, maxFaces)
+	       && readTable(f, loaded.faceCoord, maxFaces) && readTable(f, loaded.faceCubes, maxFaces)
+	       && readTable(f, loaded.faceNeighbors, maxFaces) && readTable(f, loaded.faceCubeCount, maxFaces)
+	       && readTable(f, loaded.freeCubeSlots, maxCubes) && readTable(f, loaded.freeFaceSlots, maxFaces);
+	fclose(f);
+
+	// The tables of one kind must agree in size and the maps must point into them
+	if (ok) {
+		const size_t cubeSlotCount = loaded.cubeId.size(), faceSlotCount = loaded.faceId.size();
+		ok = static_cast<int>(cubeSlots.size()) == cubes && static_cast<int>(faceSlots.size()) == faces
+		  && static_cast<int>(boundarySlots.size()) == boundaryFaces
+		  && loaded.cubeCoord.size() == cubeSlotCount && loaded.cubeFaces.size() == cubeSlotCount
+		  && loaded.cubeNeighbors.size() == cubeSlotCount && loaded.cubeMask.size() == cubeSlotCount
+		  && loaded.faceBId.size() == faceSlotCount && loaded.faceCoord.size() == faceSlotCount
+		  && loaded.faceCubes.size() == faceSlotCount && loaded.faceNeighbors.size() == faceSlotCount
+		  && loaded.faceCubeCount.size() == faceSlotCount;
+		for (Slot s : cubeSlots) ok = ok && s < cubeSlotCount;
+		for (Slot s : faceSlots) ok = ok && s < faceSlotCount;
+		for (Slot s : boundarySlots) ok = ok && s < faceSlotCount;
+
+		// A corrupt file must not leave a link that the first move follows out of the tables
+		ok = ok && linksInRange(loaded.cubeFaces, faceSlotCount) && linksInRange(loaded.cubeNeighbors, cubeSlotCount)
+		        && linksInRange(loaded.faceCubes, cubeSlotCount) && linksInRange(loaded.faceNeighbors, faceSlotCount);
+		for (Slot s : loaded.freeCubeSlots) ok = ok && s < cubeSlotCount;
+		for (Slot s : loaded.freeFaceSlots) ok = ok && s < faceSlotCount;
+		for (uint8_t n : loaded.faceCubeCount) ok = ok && n <= 2;
+		for (int id = 0; ok && id < cubes; id++) ok = loaded.cubeId[cubeSlots[id]] == id;
+		for (int id = 0; ok && id < faces; id++) ok = loaded.faceId[faceSlots[id]] == id;
+		for (int bId = 0; ok && bId < boundaryFaces; bId++) ok = loaded.faceBId[boundarySlots[bId]] == bId;
+	}
+
+	if (!ok) {
+		fprintf(stderr, "Invalid checkpoint file: %s\n", filename.c_str());
+		return false;
+	}
+
+	cubeMap = std::move(cubeSlots);
+	faceMap = std::move(faceSlots);
+	BoundaryFaces = std::move(boundarySlots);
+
+	nextCubeId = cubes;
+	nextFaceId = faces;
+	nextFaceBId = boundaryFaces;
+
+	store = std::move(loaded);
+	setCouplings(couplings);
+	rng = stream;
+	context->cycle = cycle;
+	context->tune = tune;
+	rebuildCoordinates();
+	capacityReported = false;
+
+	growthChain.clear();
+	bucketsValid = false;
+	regionMark.clear();
+	regionEpoch = 0;
+
+	return true;
+}
+
+
+#endif
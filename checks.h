@@ -16,10 +16,64 @@ void Ball::performAllChecks() {
    validateCubeNeighbors();
    validateBoundaryCube();
    validateBoundaryFaceNeighbors();
+   validateLookupTables();
+   validateMoveBuckets();
+   validateCoordinateSums();
 
 }
 
 
+void Ball::validateCoordinateSums() {
+    int64_t x = 0, y = 0, z = 0, squares = 0;
+    for (int i = 0; i < nextCubeId; i++) {
+        const Vector3& v = store.cubeCoord[cubeMap[i]];
+        assert(cubeX[i] == v.x && cubeY[i] == v.y && cubeZ[i] == v.z);
+        x += v.x; y += v.y; z += v.z;
+        squares += static_cast<int64_t>(v.x)*v.x + static_cast<int64_t>(v.y)*v.y + static_cast<int64_t>(v.z)*v.z;
+    }
+    assert(x == sumX && y == sumY && z == sumZ && squares == sumSquares);
+}
+
+
+void Ball::validateMoveBuckets() {
+    if (!bucketsValid) return;
+
+    int counted[2][5] = {{0}};
+    for (int i = 0; i < nextFaceBId; i++) {
+        const Slot face = BoundaryFaces[i];
+        const int growNB = CheckValidGrow(faceAt(face)).first;
+        const int shrinkNB = CheckValidShrink(faceAt(face)).first;
+
+        assert(buckets.getClass(MoveGrow, face) == (growNB == -1 ? -1 : MoveBuckets::classOf(growNB)));
+        assert(buckets.getClass(MoveShrink, face) == (shrinkNB == -1 ? -1 : MoveBuckets::classOf(shrinkNB)));
+
+        if (growNB != -1) counted[MoveGrow][MoveBuckets::classOf(growNB)]++;
+        if (shrinkNB != -1) counted[MoveShrink][MoveBuckets::classOf(shrinkNB)]++;
+    }
+
+    for (int move = 0; move < 2; move++) {
+        for (int cls = 0; cls < 5; cls++) assert(buckets.count(move, cls) == counted[move][cls]);
+    }
+}
+
+
+void Ball::validateLookupTables() {
+    for (int i = 0; i < nextFaceBId; i++) {
+        Face face = faceAt(BoundaryFaces[i]);
+
+        const std::pair<int, Face> grow = CheckValidGrow(face);
+        const std::pair<int, Face> growWalk = CheckValidGrowWalk(face);
+        assert(grow.first == growWalk.first);
+        if (grow.first != -1) assert(grow.second == growWalk.second);
+
+        const std::pair<int, Face> shrink = CheckValidShrink(face);
+        const std::pair<int, Face> shrinkWalk = CheckValidShrinkWalk(face);
+        assert(shrink.first == shrinkWalk.first);
+        if (shrink.first != -1) assert(shrink.second == shrinkWalk.second);
+    }
+}
+
+
 void Ball::validateBoundaryCube() {
     printf("Check if a boundary cube has no possible cube on the boundary\n");
 
@@ -33,45 +87,45 @@ void Ball::validateBoundaryCube() {
     };
 
     for (size_t i = 0; i < nextFaceBId; i++) {
-        Face* face = BoundaryFaces[i];
-        Cube* cube = face->getCube();
-        Vector3 direction = face->getVector();
+        Face face = faceAt(BoundaryFaces[i]);
+        Cube cube = face.getCube();
+        Vector3 direction = face.getVector();
         
 
 		 auto orthogonals = direction.getOrthogonal(); // 4 orthogonal directions (no allocation)
 		 
 		 		
         // Check the cube at the boundary direction
-        assert( cube->getNeighbor(direction) == nullptr); // There should be no cube in the boundary direction
+        assert( !cube.getNeighbor(direction)); // There should be no cube in the boundary direction
 
-		Cube * neighbor = nullptr;
+		Cube neighbor;
 			
 		for(int j = 0 ; j < 4 ; j++) {
-			neighbor = cube->getNeighbor(orthogonals[j]); //sideCubes_below
+			neighbor = cube.getNeighbor(orthogonals[j]); //sideCubes_below
 			if(neighbor) {
-				if(neighbor->getNeighbor(orthogonals[j]*-1 + direction)) {
-					printf(" ASSERT : cube:%d\t nb:%d->%d\n",cube->getId(),neighbor->getId(),neighbor->getNeighbor(orthogonals[j]*-1 + direction)->getId());
+				if(neighbor.getNeighbor(orthogonals[j]*-1 + direction)) {
+					printf(" ASSERT : cube:%d\t nb:%d->%d\n",cube.getId(),neighbor.getId(),neighbor.getNeighbor(orthogonals[j]*-1 + direction).getId());
 					direction.printCoord();
 					orthogonals[j].printCoord();
-					assert(!neighbor->getNeighbor(orthogonals[j]*-1 + direction));
+					assert(!neighbor.getNeighbor(orthogonals[j]*-1 + direction));
 				}
 			}
 						
-			neighbor = cube->getNeighbor(orthogonals[j]+orthogonals[(j+1)%4]); //cornerCubes_below
-			if(neighbor) assert(!neighbor->getNeighbor(orthogonals[(j+1)%4]*-1 + orthogonals[j]*-1 + direction));
+			neighbor = cube.getNeighbor(orthogonals[j]+orthogonals[(j+1)%4]); //cornerCubes_below
+			if(neighbor) assert(!neighbor.getNeighbor(orthogonals[(j+1)%4]*-1 + orthogonals[j]*-1 + direction));
 			
-			neighbor = cube->getNeighbor(orthogonals[j] + direction); //sideCubes_layer
-			if(neighbor) assert(!neighbor->getNeighbor(orthogonals[j]*-1));
+			neighbor = cube.getNeighbor(orthogonals[j] + direction); //sideCubes_layer
+			if(neighbor) assert(!neighbor.getNeighbor(orthogonals[j]*-1));
 			
-			neighbor = cube->getNeighbor(orthogonals[j]+orthogonals[(j+1)%4] + direction); //cornerCubes_layers
+			neighbor = cube.getNeighbor(orthogonals[j]+orthogonals[(j+1)%4] + direction); //cornerCubes_layers
 			if(neighbor) {
-				if(neighbor->getNeighbor(orthogonals[j]*-1+orthogonals[(j+1)%4]*-1)) {
+				if(neighbor.getNeighbor(orthogonals[j]*-1+orthogonals[(j+1)%4]*-1)) {
 					
-					printf(" ASSERT : cube:%d\t nb:%d->%d\n",cube->getId(),neighbor->getId(),neighbor->getNeighbor(orthogonals[j]*-1+orthogonals[(j+1)%4]*-1)->getId());
+					printf(" ASSERT : cube:%d\t nb:%d->%d\n",cube.getId(),neighbor.getId(),neighbor.getNeighbor(orthogonals[j]*-1+orthogonals[(j+1)%4]*-1).getId());
 					
 
 					
-					assert(!neighbor->getNeighbor(orthogonals[j]*-1+orthogonals[(j+1)%4]*-1));
+					assert(!neighbor.getNeighbor(orthogonals[j]*-1+orthogonals[(j+1)%4]*-1));
 				}
 			}
 			
@@ -96,14 +150,14 @@ void Ball::validateCubeNeighbors() {
     };
 
     for (int i = 0; i < nextCubeId; i++) {
-        Cube* cube = cubeMap[i];
+        Cube cube = cubeAt(cubeMap[i]);
         assert(cube); // Ensure the cube exists
 
         for (int j = 0; j < 6; j++) {
-            Cube* neighbor = cube->getNeighbor(directions[j]);
+            Cube neighbor = cube.getNeighbor(directions[j]);
             if (neighbor) { // If a neighbor exists in this direction
                 // Check reverse relationship
-                Cube* reverseNeighbor = neighbor->getNeighbor(directions[j] * -1);
+                Cube reverseNeighbor = neighbor.getNeighbor(directions[j] * -1);
                 assert(reverseNeighbor == cube); // The neighbor's neighbor in the opposite direction should be the original cube
             }
         }
@@ -127,14 +181,14 @@ void Ball::validateAllCubeFaces() {
     
 
     for (int i = 0; i < nextCubeId; i++) {
-        Cube* cube = cubeMap[i];
+        Cube cube = cubeAt(cubeMap[i]);
         assert(cube);
         
         for(int j = 0 ; j < 6 ; j++) {
-	        Face * face = cube->getFace(directions[j]);
+	        Face face = cube.getFace(directions[j]);
 	        
-	         if (face->getIsBoundary()) face->getVector().validateNonZero();
-             else face->getVector().validateZero();
+	         if (face.getIsBoundary()) face.getVector().validateNonZero();
+             else face.getVector().validateZero();
         }
     }
 
@@ -144,24 +198,24 @@ void Ball::validateAllCubeFaces() {
 void Ball::validateBoundaryFaces() {
 //	printf("##################### VALIDATE BOUNDARY FACES #####################\n");
     for (size_t i = 0; i < nextFaceBId; i++) {
-        Face* face = BoundaryFaces[i];
+        Face face = faceAt(BoundaryFaces[i]);
         
-        Cube * cube = face->getCube();
-        Vector3 direction = face->getVector();
-  //      printf("faceid boundary id: %d %d\n",face->getId(),face->getBId());
-//		printf(" sits with boundary %d\t \n",face->getIsBoundary());
+        Cube cube = face.getCube();
+        Vector3 direction = face.getVector();
+  //      printf("faceid boundary id: %d %d\n",face.getId(),face.getBId());
+//		printf(" sits with boundary %d\t \n",face.getIsBoundary());
 		
-	//	if(face->getIsBoundary() == 0) printf("on Cube: %d \t",cube->getId());
+	//	if(face.getIsBoundary() == 0) printf("on Cube: %d \t",cube.getId());
         
-        assert(face->getIsBoundary() != 0);
+        assert(face.getIsBoundary() != 0);
         
         direction.validateNonZero();
         
-        assert(cube->getFace(direction) == face);
+        assert(cube.getFace(direction) == face);
 
 
         // Assert that each face marked as a boundary actually has the isBoundary flag set to true
-//        assert(face->isBoundary && "Boundary face does not have isBoundary set to true");
+//        assert(face.isBoundary && "Boundary face does not have isBoundary set to true");
     }
     
 //    printf("##################### ALL DONE #####################\n");
@@ -169,70 +223,70 @@ void Ball::validateBoundaryFaces() {
 
 
 void Ball::validateBoundaryFaceNeighbors() {
-    Face* neighborFace = nullptr;
-    Face* backFace = nullptr;
+    Face neighborFace;
+    Face backFace;
     int faceBId = 0, faceId;
-    Face* face = nullptr;
-    Cube * cube = nullptr;
+    Face face;
+    Cube cube;
     
    for (size_t i = 0; i < nextFaceBId; i++) {
 	//    printf(" I = %ld\n",i);
-        face = BoundaryFaces[i];
+        face = faceAt(BoundaryFaces[i]);
         
-        faceBId = face->getBId();
-        faceId = face->getId();
-        face->printNeighbors();
+        faceBId = face.getBId();
+        faceId = face.getId();
+        face.printNeighbors();
 
-        Vector3 direction = face->getVector();
-		face->printNeighbors();
+        Vector3 direction = face.getVector();
+		face.printNeighbors();
 		
         auto orthogonals = direction.getOrthogonal();
         
         
 
-        assert(face->getIsBoundary() == 1);
+        assert(face.getIsBoundary() == 1);
 		
 		//direction.printCoord();        
 
         direction.validateNonZero();
         
-        face->checkNeighborDirections();
+        face.checkNeighborDirections();
         
         
-        cube = face->getCube();
-        assert(cube->getFace(direction) == face);
+        cube = face.getCube();
+        assert(cube.getFace(direction) == face);
         
-       // printf("i:%ld/%d faceID: %d\tfaceBID:  %d\t cubeID: %d\tj:\n",i,nextFaceBId-1,faceId,faceBId,cube->getId());
+       // printf("i:%ld/%d faceID: %d\tfaceBID:  %d\t cubeID: %d\tj:\n",i,nextFaceBId-1,faceId,faceBId,cube.getId());
         for(int j = 0 ; j < 4 ; j++) {
         
         //	printf(" in Loop %d\t",j);
         	
-        	neighborFace = face->getAdjacent(orthogonals[j]);
+        	neighborFace = face.getAdjacent(orthogonals[j]);
         	
-        	//printf("cubeID: %d\t",neighborFace->getCube()->getId());
+        	//printf("cubeID: %d\t",neighborFace.getCube().getId());
         	
         	assert(neighborFace);
         	
-        	//neighborFace->printNeighbors();
+        	//neighborFace.printNeighbors();
         	
         	//printf("after assert \n");
         	
     		
-    		if (neighborFace->getVector() == direction) backFace =  neighborFace->getAdjacent(orthogonals[j] * -1);  
-	        else if(neighborFace->getVector() == orthogonals[j]) backFace = neighborFace->getAdjacent(direction);  
-        	else backFace = neighborFace->getAdjacent(direction * -1);  
+    		if (neighborFace.getVector() == direction) backFace =  neighborFace.getAdjacent(orthogonals[j] * -1);  
+	        else if(neighborFace.getVector() == orthogonals[j]) backFace = neighborFace.getAdjacent(direction);  
+        	else backFace = neighborFace.getAdjacent(direction * -1);  
         	
         	//printf("before next assert \n");
         	
         	//if(!backFace) {
         	//	printf(" WUT ?\n");
         		
-        		//face->printNeighbors();
+        		//face.printNeighbors();
         	//	}
         	
-        	//if(backFace->getBId() != faceBId) {printf(" BID: %d %d\n",backFace->getBId(),faceBId);}
+        	//if(backFace.getBId() != faceBId) {printf(" BID: %d %d\n",backFace.getBId(),faceBId);}
         	
-        	assert(backFace->getBId() == faceBId);
+        	assert(backFace.getBId() == faceBId);
         	
         	//printf("this failed? \n");
         }
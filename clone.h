@@ -0,0 +1,53 @@
+#pragma once
+#ifndef CLONE_H
+#define CLONE_H
+
+/*
+ * Deep copies of a ball.
+ *
+ * Cubes and faces live in the slot tables of the CubulationStore and refer to
+ * each other by slot index, so a copy of the tables is already a consistent,
+ * independent cubulation: nothing has to be relocated and no object is
+ * allocated on its own. Copying into a ball that already has tables (a
+ * replica, an earlier clone) reuses their capacity, so it does not allocate
+ * at all while the source fits.
+ *
+ * Only the cubulation and what is derived from it (id maps, boundary list,
+ * packed coordinates and sums, rejection-free buckets) is copied. Couplings,
+ * random stream, context and move statistics belong to the run of the target.
+ */
+
+#include "ball.h"
+
+// A new ball for another run (context) with this cubulation; couplings and
+// random stream (the long_jump() of its seed) come from the parameters of that run
+Ball Ball::clone(SimulationContext& ctx) const {
+	return Ball(ctx, *this);
+}
+
+void Ball::copyCubulation(const Ball& source) {
+	if (&source == this) return;
+
+	store = source.store;
+	cubeMap = source.cubeMap;
+	faceMap = source.faceMap;
+	BoundaryFaces = source.BoundaryFaces;
+	nextCubeId = source.nextCubeId;
+	nextFaceId = source.nextFaceId;
+	nextFaceBId = source.nextFaceBId;
+
+	cubeX = source.cubeX;
+	cubeY = source.cubeY;
+	cubeZ = source.cubeZ;
+	sumX = source.sumX; sumY = source.sumY; sumZ = source.sumZ;
+	sumSquares = source.sumSquares;
+
+	buckets = source.buckets;
+	bucketsValid = source.bucketsValid;
+
+	measureCount = 0;
+	capacityReported = false;
+	growthChain.clear();
+}
+
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+#ifndef COMPACT_H
+#define COMPACT_H
+
+/*
+ * Spatial compaction of the slot tables.
+ *
+ * Swap-with-last deletion and the LIFO free lists leave neighbouring cubes in
+ * unrelated slots after many moves. compactStorage() renumbers the cube slots
+ * along a Morton curve of the cube coordinates (cubes sharing a coordinate
+ * keep their relative order) and gives every face the next free slot when its
+ * first cube is visited, then rewrites every link. Ids and boundary ids are not
+ * touched and the rejection-free buckets keep their order, so the Markov chain
+ * is exactly the same with or without compaction.
+ */
+
+#include <algorithm>
+#include "ball.h"
+
+// Spread the low 21 bits of v so there are two zero bits between each
+static inline uint64_t spreadBits21(uint64_t v) {
+	v &= 0x1fffff;
+	v = (v | v << 32) & 0x1f00000000ffffull;
+	v = (v | v << 16) & 0x1f0000ff0000ffull;
+	v = (v | v << 8)  & 0x100f00f00f00f00full;
+	v = (v | v << 4)  & 0x10c30c30c30c30c3ull;
+	v = (v | v << 2)  & 0x1249249249249249ull;
+	return v;
+}
+
+static inline uint64_t mortonKey(uint32_t x, uint32_t y, uint32_t z) {
+	return spreadBits21(x) | spreadBits21(y) << 1 | spreadBits21(z) << 2;
+}
+
+// Rebuild one table in the new slot order (order[new] = old), mapping each row through remap
+template<typename Table, typename Remap> static void permuteTable(Table& table, const std::vector<Slot>& order, Remap remap) {
+	Table next;
+	next.reserve(table.capacity());
+	for (Slot old : order) next.push_back(remap(table[old]));
+	table.swap(next);
+}
+
+
+void Ball::compactStorage() {
+	// Morton keys relative to the bounding box of the ball
+	int32_t minX = cubeX[0], minY = cubeY[0], minZ = cubeZ[0];
+	for (int i = 1; i < nextCubeId; i++) {
+		minX = std::min(minX, cubeX[i]); minY = std::min(minY, cubeY[i]); minZ = std::min(minZ, cubeZ[i]);
+	}
+
+	std::vector<std::pair<uint64_t, Slot>> keyed(nextCubeId);
+	for (int i = 0; i < nextCubeId; i++) {
+		keyed[i] = {mortonKey(cubeX[i] - minX, cubeY[i] - minY, cubeZ[i] - minZ), cubeMap[i]};
+	}
+	std::sort(keyed.begin(), keyed.end());
+
+	std::vector<Slot> cubeOrder(nextCubeId), faceOrder;
+	std::vector<Slot> cubeRemap(store.cubeId.size(), NoSlot), faceRemap(store.faceId.size(), NoSlot);
+	faceOrder.reserve(nextFaceId);
+	for (int i = 0; i < nextCubeId; i++) {
+		const Slot cube = keyed[i].second;
+		cubeOrder[i] = cube;
+		cubeRemap[cube] = i;
+		for (Slot face : store.cubeFaces[cube]) {
+			if (face == NoSlot || faceRemap[face] != NoSlot) continue;
+			faceRemap[face] = static_cast<Slot>(faceOrder.size());
+			faceOrder.push_back(face);
+		}
+	}
+	// Faces no cube points to (should not exist, but keep them rather than lose them)
+	for (int i = 0; i < nextFaceId; i++) {
+		if (faceRemap[faceMap[i]] != NoSlot) continue;
+		faceRemap[faceMap[i]] = static_cast<Slot>(faceOrder.size());
+		faceOrder.push_back(faceMap[i]);
+	}
+
+	auto cubeLink = [&cubeRemap](Slot s) { return s == NoSlot ? NoSlot : cubeRemap[s]; };
+	auto faceLink = [&faceRemap](Slot s) { return s == NoSlot ? NoSlot : faceRemap[s]; };
+	auto same = [](const auto& row) { return row; };
+	auto cubeLinks = [&cubeLink](auto row) { for (Slot& s : row) s = cubeLink(s); return row; };
+	auto faceLinks = [&faceLink](auto row) { for (Slot& s : row) s = faceLink(s); return row; };
+
+	permuteTable(store.cubeId, cubeOrder, same);
+	permuteTable(store.cubeCoord, cubeOrder, same);
+	permuteTable(store.cubeFaces, cubeOrder, faceLinks);
+	permuteTable(store.cubeNeighbors, cubeOrder, cubeLinks);
+	permuteTable(store.cubeMask, cubeOrder, same);
+
+	permuteTable(store.faceId, faceOrder, same);
+	permuteTable(store.faceBId, faceOrder, same);
+	permuteTable(store.faceCoord, faceOrder, same);
+	permuteTable(store.faceCubes, faceOrder, cubeLinks);
+	permuteTable(store.faceNeighbors, faceOrder, faceLinks);
+	permuteTable(store.faceCubeCount, faceOrder, same);
+
+	// Every live object is in the dense prefix now, nothing left to recycle
+	store.freeCubeSlots.clear();
+	store.freeFaceSlots.clear();
+
+	for (int i = 0; i < nextCubeId; i++) cubeMap[i] = cubeRemap[cubeMap[i]];
+	for (int i = 0; i < nextFaceId; i++) faceMap[i] = faceRemap[faceMap[i]];
+	for (int i = 0; i < nextFaceBId; i++) BoundaryFaces[i] = faceRemap[BoundaryFaces[i]];
+
+	// The rejection-free buckets hold slots; renumber them in place so the draw order is unchanged
+	if (bucketsValid) buckets.remap(faceRemap);
+	regionMark.clear();
+	regionEpoch = 0;
+}
+
+
+#endif
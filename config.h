@@ -38,10 +38,19 @@ public:
 
 	int getInt(std::string key) { return std::stoi(dict[key]); }
 
+	// Optional keys fall back to a default when missing from the config file.
+	int getInt(std::string key, int fallback) { return has(key) ? std::stoi(dict[key]) : fallback; }
+
+	bool has(std::string key) const { return dict.find(key) != dict.end(); }
+
 	double getDouble(std::string key) { return std::stod(dict[key]); }
+	double getDouble(std::string key, double fallback) { return has(key) ? std::stod(dict[key]) : fallback; }
 
 	std::string getString(std::string key) { return dict[key]; }
 
+	// Overrides one value, used by the sweep driver for the points of a grid
+	void set(std::string key, std::string value) { dict[key] = value; }
+
 private:
 	std::unordered_map<std::string, std::string> dict;
 };
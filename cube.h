@@ -2,12 +2,18 @@
 #ifndef CUBE_H
 #define CUBE_H
 
+#include <algorithm>
 #include <array>
 #include <string>
 #include <cstdio>
 #include <iostream>
 #include <cmath> // For std::sqrt
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
 struct Vector3 {
     int x, y, z;
 
@@ -15,18 +21,18 @@ struct Vector3 {
     constexpr Vector3(int x = 0, int y = 0, int z = 0) : x(x), y(y), z(z) {}
         
     // Equality comparison
-    bool operator==(const Vector3& other) const { return x == other.x && y == other.y && z == other.z; }
+    constexpr bool operator==(const Vector3& other) const { return x == other.x && y == other.y && z == other.z; }
     
-    bool operator!=(const Vector3& other) const { return !(x == other.x && y == other.y && z == other.z); }
+    constexpr bool operator!=(const Vector3& other) const { return !(x == other.x && y == other.y && z == other.z); }
 
     // Vector addition
-    Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
+    constexpr Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
 
     // Vector subtraction
-    Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
+    constexpr Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
     
     // Scalar multiplication
-    Vector3 operator*(int scalar) const { return Vector3(x * scalar, y * scalar, z * scalar); }
+    constexpr Vector3 operator*(int scalar) const { return Vector3(x * scalar, y * scalar, z * scalar); }
     
     // Scalar division
     Vector3 operator/(int scalar) const { return Vector3(x / scalar, y / scalar, z / scalar); }
@@ -38,24 +44,18 @@ struct Vector3 {
     
     Vector3 * getVector() { return this; };
     
-    static inline bool isAxisAligned(const Vector3& v) {
+    static constexpr bool isAxisAligned(const Vector3& v) {
         const int nonZero = (v.x != 0) + (v.y != 0) + (v.z != 0);
         return nonZero == 1 && ((v.x == 1 || v.x == -1) || (v.y == 1 || v.y == -1) || (v.z == 1 || v.z == -1));
     }
 
-    static inline int axisIndex(const Vector3& v) {
+    static constexpr int axisIndex(const Vector3& v) {
         // +x,+y,+z,-x,-y,-z
-        if (v.x == 1 && v.y == 0 && v.z == 0) return 0;
-        if (v.x == 0 && v.y == 1 && v.z == 0) return 1;
-        if (v.x == 0 && v.y == 0 && v.z == 1) return 2;
-        if (v.x == -1 && v.y == 0 && v.z == 0) return 3;
-        if (v.x == 0 && v.y == -1 && v.z == 0) return 4;
-        if (v.x == 0 && v.y == 0 && v.z == -1) return 5;
-        assert(false && "Expected axis-aligned unit vector");
-        return 0;
+        assert(isAxisAligned(v) && "Expected axis-aligned unit vector");
+        return (v.y != 0) + 2 * (v.z != 0) + 3 * (v.x + v.y + v.z < 0);
     }
 
-    static inline Vector3 axisFromIndex(int idx) {
+    static constexpr Vector3 axisFromIndex(int idx) {
         switch (idx) {
             case 0: return Vector3(1, 0, 0);
             case 1: return Vector3(0, 1, 0);
@@ -67,7 +67,7 @@ struct Vector3 {
         }
     }
 
-    static inline int neighborIndex(const Vector3& v) {
+    static constexpr int neighborIndex(const Vector3& v) {
         // v components must be in [-1, 1] and v != (0,0,0)
         assert(v.x >= -1 && v.x <= 1);
         assert(v.y >= -1 && v.y <= 1);
@@ -76,7 +76,10 @@ struct Vector3 {
         return (v.x + 1) * 9 + (v.y + 1) * 3 + (v.z + 1);
     }
 
-    static inline Vector3 neighborFromIndex(int idx) {
+    // Entry of neighbour index idx in a cubeNeighbors row; the centre (13) has none
+    static constexpr int neighborRow(int idx) { return idx - (idx > 13); }
+
+    static constexpr Vector3 neighborFromIndex(int idx) {
         assert(idx >= 0 && idx < 27);
         const int dx = (idx / 9) - 1;
         const int dy = ((idx % 9) / 3) - 1;
@@ -85,7 +88,7 @@ struct Vector3 {
     }
     
     // For axis-aligned vectors, return the 4 orthogonal directions without allocating.
-    std::array<Vector3, 4> getOrthogonal() const {
+    constexpr std::array<Vector3, 4> getOrthogonal() const {
         // This codebase only calls getOrthogonal() for axis-aligned directions (faces).
         assert((x != 0 && y == 0 && z == 0) || (y != 0 && x == 0 && z == 0) || (z != 0 && x == 0 && y == 0));
 
@@ -119,123 +122,216 @@ struct Vector3 {
 	
 };
 
-class Cube; // Forward declaration to resolve circular dependency
+// Slot index into the CubulationStore tables. Links between cubes and faces
+// are stored as 32-bit slots instead of heap pointers; NoSlot marks an empty link.
+typedef uint32_t Slot;
+static constexpr Slot NoSlot = 0xffffffffu;
+
+// Allocator for the store tables: every table starts on a cache line, so the
+// rows of neighbouring slots share lines the same way in every table.
+template<typename T, size_t Align = 64> struct SlabAllocator {
+	typedef T value_type;
+	template<typename U> struct rebind { typedef SlabAllocator<U, Align> other; };
+
+	SlabAllocator() = default;
+	template<typename U> SlabAllocator(const SlabAllocator<U, Align>&) {}
+
+	T* allocate(size_t n) {
+		const size_t bytes = (n * sizeof(T) + Align - 1) / Align * Align;
+		void* p = std::aligned_alloc(Align, bytes);
+		if (!p) throw std::bad_alloc();
+		return static_cast<T*>(p);
+	}
+	void deallocate(T* p, size_t) { std::free(p); }
+
+	template<typename U> bool operator==(const SlabAllocator<U, Align>&) const { return true; }
+	template<typename U> bool operator!=(const SlabAllocator<U, Align>&) const { return false; }
+};
+
+template<typename T> using SlabTable = std::vector<T, SlabAllocator<T>>;
+
+// Structure-of-arrays storage for the whole cubulation. Every cube and face is a
+// slot in contiguous tables, so the move kernels walk cache-resident index
+// arrays instead of chasing individually allocated objects.
+struct CubulationStore {
+	// Cube tables (indexed by cube slot)
+	SlabTable<int> cubeId;
+	SlabTable<Vector3> cubeCoord;
+	SlabTable<std::array<Slot, 6>> cubeFaces;
+	SlabTable<std::array<Slot, 26>> cubeNeighbors; // the 26 offsets in {-1,0,1}^3 around the cube, see Vector3::neighborRow
+	SlabTable<uint32_t> cubeMask; // bit k set iff neighbour index k is occupied
+
+	// Face tables (indexed by face slot)
+	SlabTable<int> faceId;
+	SlabTable<int> faceBId;
+	SlabTable<Vector3> faceCoord;
+	SlabTable<std::array<Slot, 6>> faceCubes;
+	SlabTable<std::array<Slot, 6>> faceNeighbors;
+	SlabTable<uint8_t> faceCubeCount;
+
+	// Recycled slots (LIFO, like the old object pools)
+	std::vector<Slot> freeCubeSlots;
+	std::vector<Slot> freeFaceSlots;
+
+	// Tables grow by whole slabs of this many slots (at least doubling), all tables of a kind at once
+	static constexpr size_t SlabSlots = 4096;
+
+	// Make room for this many cube and face slots without reallocating during growth
+	void reserve(size_t cubes, size_t faces) {
+		cubes = (cubes + SlabSlots - 1) / SlabSlots * SlabSlots;
+		faces = (faces + SlabSlots - 1) / SlabSlots * SlabSlots;
+		if (cubes > cubeId.capacity()) {
+			cubeId.reserve(cubes); cubeCoord.reserve(cubes); cubeFaces.reserve(cubes);
+			cubeNeighbors.reserve(cubes); cubeMask.reserve(cubes);
+		}
+		if (faces > faceId.capacity()) {
+			faceId.reserve(faces); faceBId.reserve(faces); faceCoord.reserve(faces);
+			faceCubes.reserve(faces); faceNeighbors.reserve(faces); faceCubeCount.reserve(faces);
+		}
+	}
+
+	// Drop every cube and face in one go; the slabs stay allocated for the next ball
+	void reset() {
+		cubeId.clear(); cubeCoord.clear(); cubeFaces.clear(); cubeNeighbors.clear(); cubeMask.clear();
+		faceId.clear(); faceBId.clear(); faceCoord.clear(); faceCubes.clear(); faceNeighbors.clear(); faceCubeCount.clear();
+		freeCubeSlots.clear();
+		freeFaceSlots.clear();
+	}
 
+	Slot allocCubeSlot() {
+		Slot slot;
+		if (!freeCubeSlots.empty()) {
+			slot = freeCubeSlots.back();
+			freeCubeSlots.pop_back();
+		} else {
+			slot = static_cast<Slot>(cubeId.size());
+			if (cubeId.size() == cubeId.capacity()) reserve(std::max(2 * cubeId.size(), cubeId.size() + 1), 0);
+			cubeId.emplace_back();
+			cubeCoord.emplace_back();
+			cubeFaces.emplace_back();
+			cubeNeighbors.emplace_back();
+			cubeMask.emplace_back();
+		}
+		cubeId[slot] = -1;
+		cubeCoord[slot] = {0, 0, 0};
+		cubeFaces[slot].fill(NoSlot);
+		cubeNeighbors[slot].fill(NoSlot);
+		cubeMask[slot] = 0;
+		return slot;
+	}
 
+	Slot allocFaceSlot() {
+		Slot slot;
+		if (!freeFaceSlots.empty()) {
+			slot = freeFaceSlots.back();
+			freeFaceSlots.pop_back();
+		} else {
+			slot = static_cast<Slot>(faceId.size());
+			if (faceId.size() == faceId.capacity()) reserve(0, std::max(2 * faceId.size(), faceId.size() + 1));
+			faceId.emplace_back();
+			faceBId.emplace_back();
+			faceCoord.emplace_back();
+			faceCubes.emplace_back();
+			faceNeighbors.emplace_back();
+			faceCubeCount.emplace_back();
+		}
+		faceId[slot] = -1;
+		faceBId[slot] = -1;
+		faceCoord[slot] = {0, 0, 0};
+		faceCubes[slot].fill(NoSlot);
+		faceNeighbors[slot].fill(NoSlot);
+		faceCubeCount[slot] = 0;
+		return slot;
+	}
+
+	void freeCubeSlot(Slot slot) { freeCubeSlots.push_back(slot); }
+	void freeFaceSlot(Slot slot) { freeFaceSlots.push_back(slot); }
+};
+
+class Cube; // Forward declaration to resolve circular dependency
+
+// Lightweight handle (store + slot) to a face in a CubulationStore.
 class Face {
+private:
+	CubulationStore * store;
+	Slot slot;
+
 public:
-    int id;
-    int bId;
-    bool isBoundary;
-    std::array<Cube*, 6> cubes{};
-    std::array<Face*, 6> neighbors{};
-    int cubeCount;
-	Vector3 coordinate;
-	
-    Face( ) { Initialize(); }
-    
-    void Initialize() {
-        id = -1;
-        bId = -1;
-        coordinate = {0, 0, 0};
-        isBoundary = 1;
-        cubes.fill(nullptr);
-        neighbors.fill(nullptr);
-        cubeCount = 0;
-    }
-    
-    int getId() { return id;}
-    int getBId() { return bId;}
-    void setId(int setid) { id = setid;}
-    void setBId(int setBId) { bId = setBId;}
+	Face() : store(nullptr), slot(NoSlot) {}
+	Face(CubulationStore * store, Slot slot) : store(store), slot(slot) {}
+
+	explicit operator bool() const { return slot != NoSlot; }
+	bool operator==(const Face& other) const { return slot == other.slot; }
+	bool operator!=(const Face& other) const { return slot != other.slot; }
+
+	Slot getSlot() const { return slot; }
+
+    int getId() const { return store->faceId[slot]; }
+    int getBId() const { return store->faceBId[slot]; }
+    void setId(int setid) { store->faceId[slot] = setid; }
+    void setBId(int setBId) { store->faceBId[slot] = setBId; }
     
-    void setVector(int x, int y, int z) { coordinate = Vector3(x, y, z); }
-	void setVector(Vector3 vector) { coordinate = vector; }
-	void unsetVector() { coordinate = {0,0,0}; }
+    void setVector(int x, int y, int z) { store->faceCoord[slot] = Vector3(x, y, z); }
+	void setVector(Vector3 vector) { store->faceCoord[slot] = vector; }
+	void unsetVector() { store->faceCoord[slot] = {0,0,0}; }
 	
-	const Vector3& getVector() const { return coordinate ; }
-	std::string getVectorStr() const { return coordinate.getStr() ; }
+	const Vector3& getVector() const { return store->faceCoord[slot]; }
+	std::string getVectorStr() const { return getVector().getStr() ; }
 
-	
-	void setCube(const Vector3& direction, Cube* cube) {
-        const int idx = Vector3::axisIndex(direction);
-        if (!cubes[idx]) cubeCount++;
-        cubes[idx] = cube;
-
-        if (cubeCount == 1) {
-            isBoundary = 1;
-        } else {
-            coordinate = {0, 0, 0};
-            isBoundary = 0;
-        }
-        // Automatically determine if this face is a boundary element.
-        // If it has only one neighbor, it's a boundary; more than one, it's not.
-    }
-	
-	void printCoordStr() { std::cout << " " << coordinate.getStr() << " "; }// Using std::cout for C++ style output
-	std::string getCoordStr() { return coordinate.getStr(); }
-    
+	int getCubeCount() const { return store->faceCubeCount[slot]; }
 
+	// A face with a single glued cube is a boundary element; two cubes make it interior.
+	int getIsBoundary() const { return store->faceCubeCount[slot] <= 1; }
 
-    void unsetCube(const Vector3& direction) {
-        const int idx = Vector3::axisIndex(direction);
-        if (cubes[idx]) {
-            cubes[idx] = nullptr;
-            cubeCount--;
-            if (cubeCount == 1) isBoundary = 1;
-        }
-     }
-     
-     int getIsBoundary() {return isBoundary;}
-     
-     Face *  getAdjacent(const Vector3& direction) { return neighbors[Vector3::axisIndex(direction)]; }
+	void setCube(const Vector3& direction, Cube cube);
+	void unsetCube(const Vector3& direction);
+	void setCubeAt(int axis, Cube cube);
+	void unsetCubeAt(int axis);
+	Cube getCube(const Vector3& direction) const;
+	Cube getCube() const;
+
+	void printCoordStr() const { std::cout << " " << getVector().getStr() << " "; }// Using std::cout for C++ style output
+	std::string getCoordStr() const { return getVector().getStr(); }
 
-     void setAdjacent(const Vector3& direction, Face * face) {
+     Face getAdjacent(const Vector3& direction) const { return getAdjacentAt(Vector3::axisIndex(direction)); }
+     void setAdjacent(const Vector3& direction, Face face) { setAdjacentAt(Vector3::axisIndex(direction), face); }
+     void unsetAdjacent(const Vector3& direction) { unsetAdjacentAt(Vector3::axisIndex(direction)); }
+
+     // Same by axis index (directions.h)
+     Face getAdjacentAt(int axis) const { return Face(store, store->faceNeighbors[slot][axis]); }
+
+     void setAdjacentAt(int axis, Face face) {
         assert(face);
-        assert(face->getId() != this->getId());
-        neighbors[Vector3::axisIndex(direction)] = face;
+        assert(face.getId() != this->getId());
+        store->faceNeighbors[slot][axis] = face.slot;
      }
      
-     void unsetAdjacent(const Vector3& direction) {
-     	neighbors[Vector3::axisIndex(direction)] = nullptr;
+     void unsetAdjacentAt(int axis) {
+     	store->faceNeighbors[slot][axis] = NoSlot;
      }
      
-     void removeBoundary() { neighbors.fill(nullptr); }
-     
-     Cube* getCube(const Vector3& direction) {
-        return cubes[Vector3::axisIndex(direction)];
-    }
-    
-    Cube* getCube() {
-        // Check if the face is a boundary face with exactly one associated cube
-        if (isBoundary && cubeCount == 1) {
-            for (Cube* c : cubes) if (c) return c;
-        }
-        
-        // If not a boundary face or no cubes are associated, return nullptr
-        return nullptr;
-    }
+     void removeBoundary() { store->faceNeighbors[slot].fill(NoSlot); }
 
-	void printInfo() {
-		printf("FaceId: %d ",id);
-		printf("IsBoundary: %d ",isBoundary);
-		if(isBoundary) printf("%d\n",bId);
+	void printInfo() const {
+		printf("FaceId: %d ",getId());
+		printf("IsBoundary: %d ",getIsBoundary());
+		if(getIsBoundary()) printf("%d\n",getBId());
 		else printf("\n");
-		coordinate.printCoord();
+		getVector().printCoord();
 
 		printf("\n");
 	}
 	
 	
-    void printNeighbors() {
-    	printf("FaceId/BId: [%d,%d]:%s ",id,bId,getCoordStr().c_str()	);
+    void printNeighbors() const {
+    	printf("FaceId/BId: [%d,%d]:%s ",getId(),getBId(),getCoordStr().c_str()	);
         for (int i = 0; i < 6; i++) {
-            Face* neighborFace = neighbors[i];
+            const Face neighborFace(store, store->faceNeighbors[slot][i]);
             if (!neighborFace) continue;
             const Vector3 dir = Vector3::axisFromIndex(i);
             const std::string dirStr = dir.getStr();
-            const std::string neighborFaceDirStr = neighborFace->getCoordStr();
-            printf("[%d,%d]: ", neighborFace->getId(), neighborFace->getBId());
+            const std::string neighborFaceDirStr = neighborFace.getCoordStr();
+            printf("[%d,%d]: ", neighborFace.getId(), neighborFace.getBId());
             printf("[%s %s] ", dirStr.c_str(), neighborFaceDirStr.c_str());
             assert(neighborFaceDirStr != "0");
         }
@@ -243,85 +339,94 @@ public:
     }
 		
 	void checkNeighborDirections() const {
-        for (Face* neighborFace : neighbors) {
-            if (!neighborFace) continue;
-            const std::string neighborFaceDirStr = neighborFace->getVectorStr();
+        for (Slot neighborSlot : store->faceNeighbors[slot]) {
+            if (neighborSlot == NoSlot) continue;
+            const std::string neighborFaceDirStr = Face(store, neighborSlot).getVectorStr();
             assert(neighborFaceDirStr != "0");
         }
 	}
-    
-
 };
 
+// Lightweight handle (store + slot) to a cube in a CubulationStore.
 class Cube {
+private:
+	CubulationStore * store;
+	Slot slot;
+
 public:
-    int id;
-    Vector3 coordinate;
-    std::array<Face*, 6> faces{};
-	std::array<Cube*, 27> neighbors{}; // offsets in {-1,0,1}^3 including diagonals
-	    
-    Cube() { Initialize() ; }
-    
-	
-	void Initialize() {
-        id = -1;
-        coordinate = {0, 0, 0};
-        faces.fill(nullptr);
-        neighbors.fill(nullptr);
-    }
+	Cube() : store(nullptr), slot(NoSlot) {}
+	Cube(CubulationStore * store, Slot slot) : store(store), slot(slot) {}
+
+	explicit operator bool() const { return slot != NoSlot; }
+	bool operator==(const Cube& other) const { return slot == other.slot; }
+	bool operator!=(const Cube& other) const { return slot != other.slot; }
+
+	Slot getSlot() const { return slot; }
 
-	void setVector(int x, int y, int z) { coordinate = Vector3(x, y, z); }
-	void setVector(Vector3 vector) { coordinate = vector; }
+	void setVector(int x, int y, int z) { store->cubeCoord[slot] = Vector3(x, y, z); }
+	void setVector(Vector3 vector) { store->cubeCoord[slot] = vector; }
 	
-	const Vector3& getVector() const { return coordinate ; }
+	const Vector3& getVector() const { return store->cubeCoord[slot]; }
 	
-	void setFace(const Vector3& direction, Face* face) { faces[Vector3::axisIndex(direction)] = face; }
+	void setFace(const Vector3& direction, Face face) { setFaceAt(Vector3::axisIndex(direction), face); }
 
     // Method to remove the association of a face with the cube in a specified direction
-    void unsetFace(const Vector3& direction) {
-        faces[Vector3::axisIndex(direction)] = nullptr;
-    }
+    void unsetFace(const Vector3& direction) { unsetFaceAt(Vector3::axisIndex(direction)); }
+
+    // Same by axis index (directions.h)
+    void setFaceAt(int axis, Face face) { store->cubeFaces[slot][axis] = face.getSlot(); }
+    void unsetFaceAt(int axis) { store->cubeFaces[slot][axis] = NoSlot; }
+    Face getFaceAt(int axis) const { return Face(store, store->cubeFaces[slot][axis]); }
 
     
-    int getId() { return id;}
-    void setId(int setid) { id = setid;}
+    int getId() const { return store->cubeId[slot]; }
+    void setId(int setid) { store->cubeId[slot] = setid; }
     
-    Face* getFace(const Vector3& vector) {
-        return faces[Vector3::axisIndex(vector)];
+    Face getFace(const Vector3& vector) const { return getFaceAt(Vector3::axisIndex(vector)); }
+
+    void setNeighbor(const Vector3& vector, Cube neighbor) { setNeighborAt(Vector3::neighborIndex(vector), neighbor); }
+
+    // Same by neighbour index (directions.h)
+    void setNeighborAt(int idx, Cube neighbor) {
+    	Slot& entry = store->cubeNeighbors[slot][Vector3::neighborRow(idx)];
+    	assert(entry == NoSlot);
+    	entry = neighbor.slot;
+    	store->cubeMask[slot] |= 1u << idx;
     }
 
-    void setNeighbor(const Vector3& vector, Cube* neighbor) {
-        const int idx = Vector3::neighborIndex(vector);
-    	assert(!neighbors[idx]);
-    	neighbors[idx] = neighbor;
+    void unsetNeighborAt(int idx) {
+        store->cubeNeighbors[slot][Vector3::neighborRow(idx)] = NoSlot;
+        store->cubeMask[slot] &= ~(1u << idx);
     }
 
-    Cube* getNeighbor(const Vector3& vector) {
-        const int idx = Vector3::neighborIndex(vector);
-        return neighbors[idx];
+    Cube getNeighbor(const Vector3& vector) const {
+        return getNeighbor(Vector3::neighborIndex(vector));
     }
     
-    void unsetNeighbor(const Vector3& direction) {
-        neighbors[Vector3::neighborIndex(direction)] = nullptr;
-    }
+    void unsetNeighbor(const Vector3& direction) { unsetNeighborAt(Vector3::neighborIndex(direction)); }
+
+    // Occupancy of the 26-neighbourhood, indexed like Vector3::neighborIndex.
+    uint32_t getMask() const { return store->cubeMask[slot]; }
+
+    Cube getNeighbor(int idx) const { return Cube(store, store->cubeNeighbors[slot][Vector3::neighborRow(idx)]); }
     
     
-    Cube * getDiagonalCube(const Vector3& x1, const Vector3& x2) {
+    Cube getDiagonalCube(const Vector3& x1, const Vector3& x2) const {
         const std::array<std::array<Vector3, 2>, 2> perms = {{
             {x1, x2},
             {x2, x1},
         }};
         for (const auto& perm : perms) {
-            Cube* current = this;
-            current = current->getNeighbor(perm[0]);
+            Cube current = *this;
+            current = current.getNeighbor(perm[0]);
             if (!current) continue;
-            current = current->getNeighbor(perm[1]);
+            current = current.getNeighbor(perm[1]);
             if (current) return current;
         }
-        return nullptr;
+        return Cube();
     }
     
-	Cube * getCornerCube(const Vector3& x1, const Vector3& x2, const Vector3& x3) {
+	Cube getCornerCube(const Vector3& x1, const Vector3& x2, const Vector3& x3) const {
         const std::array<std::array<Vector3, 3>, 6> perms = {{
             {x1, x2, x3}, {x1, x3, x2},
             {x2, x1, x3}, {x2, x3, x1},
@@ -329,34 +434,34 @@ public:
         }};
 
         for (const auto& perm : perms) {
-            Cube* current = this;
-            current = current->getNeighbor(perm[0]);
+            Cube current = *this;
+            current = current.getNeighbor(perm[0]);
             if (!current) continue;
-            current = current->getNeighbor(perm[1]);
+            current = current.getNeighbor(perm[1]);
             if (!current) continue;
-            current = current->getNeighbor(perm[2]);
+            current = current.getNeighbor(perm[2]);
             if (current) return current;
         }
-        return nullptr;
+        return Cube();
 	}
 
 
     
-    Cube * getSecondNeighbor(const Vector3& vector1, const Vector3& vector2) {
-    	Cube * cube = this->getNeighbor(vector1);
+    Cube getSecondNeighbor(const Vector3& vector1, const Vector3& vector2) const {
+    	Cube cube = this->getNeighbor(vector1);
     	
-    	if(cube) return cube->getNeighbor(vector2);
+    	if(cube) return cube.getNeighbor(vector2);
     	
-    	return nullptr;
+    	return Cube();
     }
     
-    Cube * getThirdNeighbor(const Vector3& vector1, const Vector3& vector2,const Vector3& vector3) {
-    	Cube * cube = this->getNeighbor(vector1);
+    Cube getThirdNeighbor(const Vector3& vector1, const Vector3& vector2,const Vector3& vector3) const {
+    	Cube cube = this->getNeighbor(vector1);
     	
-    	if(cube) cube = cube->getNeighbor(vector2);
-    	if(cube) return cube->getNeighbor(vector3);
+    	if(cube) cube = cube.getNeighbor(vector2);
+    	if(cube) return cube.getNeighbor(vector3);
     	
-    	return nullptr;
+    	return Cube();
     }
     
     
@@ -370,10 +475,10 @@ public:
             Vector3(0, 0, -1)   // -z
         };
 
-        printf("CUBE COORD ID: %d\t",this->id);
+        printf("CUBE COORD ID: %d\t",this->getId());
         for (const auto& dir : directions) {
-            Face* f = faces[Vector3::axisIndex(dir)];
-            if (f) printf("%s: %d, ", dir.getStr().c_str(), f->getId());
+            Face f = getFace(dir);
+            if (f) printf("%s: %d, ", dir.getStr().c_str(), f.getId());
             else printf("%s: None, ", dir.getStr().c_str());
             
         }
@@ -381,17 +486,52 @@ public:
     }
     
     void printNeighbors() const {
-        printf("Cube ID %d neighbors:\n", id);
+        printf("Cube ID %d neighbors:\n", getId());
         for (int idx = 0; idx < 27; idx++) {
             if (idx == 13) continue; // (0,0,0)
-            const Cube* neighbor = neighbors[idx];
+            const Cube neighbor = getNeighbor(idx);
             if (!neighbor) continue;
             const Vector3 dir = Vector3::neighborFromIndex(idx);
-            printf("Direction (%d, %d, %d): Neighbor Cube ID %d\n", dir.x, dir.y, dir.z, neighbor->id);
+            printf("Direction (%d, %d, %d): Neighbor Cube ID %d\n", dir.x, dir.y, dir.z, neighbor.getId());
         }
     }
 
 };
 
 
+inline void Face::setCube(const Vector3& direction, Cube cube) { setCubeAt(Vector3::axisIndex(direction), cube); }
+inline void Face::unsetCube(const Vector3& direction) { unsetCubeAt(Vector3::axisIndex(direction)); }
+
+inline void Face::setCubeAt(int axis, Cube cube) {
+    Slot& entry = store->faceCubes[slot][axis];
+    if (entry == NoSlot) store->faceCubeCount[slot]++;
+    entry = cube.getSlot();
+
+    // Once a face is shared by two cubes it is interior and carries no direction.
+    if (store->faceCubeCount[slot] > 1) store->faceCoord[slot] = {0, 0, 0};
+}
+
+inline void Face::unsetCubeAt(int axis) {
+    Slot& entry = store->faceCubes[slot][axis];
+    if (entry != NoSlot) {
+        entry = NoSlot;
+        store->faceCubeCount[slot]--;
+    }
+}
+
+inline Cube Face::getCube(const Vector3& direction) const {
+    return Cube(store, store->faceCubes[slot][Vector3::axisIndex(direction)]);
+}
+
+inline Cube Face::getCube() const {
+    // Check if the face is a boundary face with exactly one associated cube
+    if (store->faceCubeCount[slot] == 1) {
+        for (Slot c : store->faceCubes[slot]) if (c != NoSlot) return Cube(store, c);
+    }
+    
+    // If not a boundary face or no cubes are associated, return an empty handle
+    return Cube();
+}
+
+
 #endif
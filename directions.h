@@ -0,0 +1,90 @@
+#pragma once
+#ifndef DIRECTIONS_H
+#define DIRECTIONS_H
+
+/*
+ * Compile-time frames of the six face directions.
+ *
+ * For a face direction d (axis index 0..5, see Vector3::axisIndex) with
+ * orthogonals o_0..o_3 (Vector3::getOrthogonal, so o_{i+2} = -o_i) the move
+ * kernels only ever need these offsets. They are stored as axis indices (for
+ * faces) and neighbour indices (Vector3::neighborIndex, for cubes), so a
+ * kernel instantiated for a fixed d indexes the store tables with constants.
+ */
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "cube.h"
+
+struct DirectionFrame {
+	// Axis indices, for faces
+	int8_t upAxis;      // d
+	int8_t downAxis;    // -d
+	int8_t sideAxis[4]; // o_i
+
+	// Neighbour indices, for cubes
+	uint8_t above;         // d
+	uint8_t below;         // -d
+	uint8_t side[4];       // o_i
+	uint8_t sideUp[4];     // o_i + d
+	uint8_t sideDown[4];   // o_i - d
+	uint8_t corner[4];     // o_i + o_{i+1}
+	uint8_t cornerUp[4];   // o_i + o_{i+1} + d
+	uint8_t cornerDown[4]; // o_i + o_{i+1} - d
+};
+
+constexpr DirectionFrame makeDirectionFrame(int d) {
+	const Vector3 direction = Vector3::axisFromIndex(d);
+	const std::array<Vector3, 4> o = direction.getOrthogonal();
+
+	DirectionFrame f{};
+	f.upAxis = static_cast<int8_t>(d);
+	f.downAxis = static_cast<int8_t>(Vector3::axisIndex(direction * -1));
+	f.above = static_cast<uint8_t>(Vector3::neighborIndex(direction));
+	f.below = static_cast<uint8_t>(Vector3::neighborIndex(direction * -1));
+	for (int i = 0; i < 4; i++) {
+		const Vector3 corner = o[i] + o[(i+1)%4];
+		f.sideAxis[i] = static_cast<int8_t>(Vector3::axisIndex(o[i]));
+		f.side[i] = static_cast<uint8_t>(Vector3::neighborIndex(o[i]));
+		f.sideUp[i] = static_cast<uint8_t>(Vector3::neighborIndex(o[i] + direction));
+		f.sideDown[i] = static_cast<uint8_t>(Vector3::neighborIndex(o[i] - direction));
+		f.corner[i] = static_cast<uint8_t>(Vector3::neighborIndex(corner));
+		f.cornerUp[i] = static_cast<uint8_t>(Vector3::neighborIndex(corner + direction));
+		f.cornerDown[i] = static_cast<uint8_t>(Vector3::neighborIndex(corner - direction));
+	}
+	return f;
+}
+
+constexpr std::array<DirectionFrame, 6> makeDirectionFrames() {
+	std::array<DirectionFrame, 6> frames{};
+	for (int d = 0; d < 6; d++) frames[d] = makeDirectionFrame(d);
+	return frames;
+}
+
+static constexpr std::array<DirectionFrame, 6> DirectionFrames = makeDirectionFrames();
+
+// The opposite of axis index a, and of neighbour index n
+static constexpr int oppositeAxis(int a) { return a < 3 ? a + 3 : a - 3; }
+static constexpr int oppositeNeighbor(int n) { return 26 - n; }
+
+// Neighbour index of the cube across face axis a
+static constexpr int axisNeighbor(int a) { return Vector3::neighborIndex(Vector3::axisFromIndex(a)); }
+
+// Call fn(std::integral_constant<int, d>{}), so fn can instantiate a kernel for the direction d
+template<typename Fn> static inline auto dispatchDirection(int d, Fn&& fn) {
+	switch (d) {
+		case 0: return fn(std::integral_constant<int, 0>{});
+		case 1: return fn(std::integral_constant<int, 1>{});
+		case 2: return fn(std::integral_constant<int, 2>{});
+		case 3: return fn(std::integral_constant<int, 3>{});
+		case 4: return fn(std::integral_constant<int, 4>{});
+		default: return fn(std::integral_constant<int, 5>{});
+	}
+}
+
+static_assert(DirectionFrames[0].side[0] == Vector3::neighborIndex(Vector3(0, 1, 0)), "frame of +x starts at +y");
+static_assert(DirectionFrames[2].cornerUp[1] == Vector3::neighborIndex(Vector3(-1, 1, 1)), "o_1 + o_2 + d of +z");
+static_assert(oppositeNeighbor(Vector3::neighborIndex(Vector3(1, -1, 0))) == Vector3::neighborIndex(Vector3(-1, 1, 0)), "mirrored neighbour");
+
+#endif
@@ -0,0 +1,203 @@
+#pragma once
+#ifndef ERRORS_H
+#define ERRORS_H
+
+/*
+ * Online error analysis of the measured observables.
+ *
+ * Every series keeps a blocking (binning) hierarchy: level k holds the sums of
+ * the means of blocks of 2^k consecutive samples, so memory is O(log N). The
+ * naive error of level k grows with k while the blocks are shorter than the
+ * autocorrelation time and levels off once they are longer; the largest error
+ * of the levels with at least BinningMinBlocks blocks is the error estimate,
+ * and
+ *
+ *   tau_int = err^2 / (2 err_0^2),   N_eff = N / (2 tau_int)
+ *
+ * Next to it JackknifeBins bins of equal size (doubled by merging neighbours
+ * when they are full, so memory stays fixed) give the jackknife error of the
+ * mean. Samples that are NaN (R, R3, R4 between full passes, momentsevery)
+ * are skipped.
+ */
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "observables.h"
+
+static constexpr long BinningMinBlocks = 64;
+static constexpr int JackknifeBins = 64;
+
+class BinningSeries {
+public:
+	void add(double x) {
+		if (std::isnan(x)) return;
+		addAt(0, x);
+
+		bins[binCount] += x;
+		if (++binFill == binSize) {
+			binFill = 0;
+			if (++binCount == JackknifeBins) { // merge neighbours, bins twice as long
+				for (int b = 0; b < JackknifeBins / 2; b++) bins[b] = bins[2*b] + bins[2*b+1];
+				for (int b = JackknifeBins / 2; b < JackknifeBins; b++) bins[b] = 0;
+				binCount = JackknifeBins / 2;
+				binSize *= 2;
+			}
+		}
+	}
+
+	long count() const { return levels.empty() ? 0 : levels[0].n; }
+	double mean() const { return count() ? levels[0].sum / levels[0].n : std::nan(""); }
+
+	// Error of the mean at blocking level k
+	double levelError(size_t k) const {
+		const Level& l = levels[k];
+		if (l.n < 2) return std::nan("");
+		const double m = l.sum / l.n;
+		return std::sqrt(std::max(0.0, l.sumSq / l.n - m*m) / (l.n - 1));
+	}
+
+	// Plateau of the level errors (naive error while there are too few samples)
+	double error() const {
+		double err = count() >= 2 ? levelError(0) : std::nan("");
+		for (size_t k = 1; k < levels.size() && levels[k].n >= BinningMinBlocks; k++) err = std::max(err, levelError(k));
+		return err;
+	}
+
+	double tau() const {
+		const double naive = count() >= 2 ? levelError(0) : 0;
+		if (naive <= 0) return 0.5;
+		const double ratio = error() / naive;
+		return 0.5 * ratio * ratio;
+	}
+
+	double effectiveSamples() const { return count() / (2 * tau()); }
+
+	// Jackknife error of the mean over the complete bins
+	double jackknifeError() const {
+		const int b = binCount;
+		if (b < 2) return std::nan("");
+		double total = 0;
+		for (int i = 0; i < b; i++) total += bins[i];
+		const double n = static_cast<double>(binSize) * b;
+		double meanLeaveOut = 0, sumSq = 0;
+		for (int i = 0; i < b; i++) meanLeaveOut += (total - bins[i]) / (n - binSize);
+		meanLeaveOut /= b;
+		for (int i = 0; i < b; i++) {
+			const double d = (total - bins[i]) / (n - binSize) - meanLeaveOut;
+			sumSq += d*d;
+		}
+		return std::sqrt(sumSq * (b - 1) / b);
+	}
+
+	// Relative error of the mean (error / |mean|)
+	double relativeError() const { return error() / std::abs(mean()); }
+
+private:
+	struct Level {
+		double sum = 0, sumSq = 0;
+		long n = 0;
+		double pending = 0;
+		bool hasPending = false;
+	};
+	std::vector<Level> levels;
+
+	std::array<double, JackknifeBins> bins = {}; // sums of the jackknife bins
+	int binCount = 0;         // complete bins
+	long binSize = 1, binFill = 0;
+
+	void addAt(size_t k, double x) {
+		if (k == levels.size()) levels.emplace_back();
+		Level& l = levels[k];
+		l.sum += x; l.sumSq += x*x; l.n++;
+		if (!l.hasPending) { l.pending = x; l.hasPending = true; return; }
+		const double pair = 0.5 * (l.pending + x);
+		l.hasPending = false;
+		addAt(k + 1, pair);
+	}
+};
+
+
+// The series of one run, fed with every measurement of the thermal cycles
+struct ObservableErrors {
+	static constexpr int Count = 6;
+	BinningSeries series[Count]; // V, A, R, R2, R3, R4
+
+	static const char* name(int i) {
+		static const char* const names[Count] = {"V", "A", "R", "R2", "R3", "R4"};
+		return names[i];
+	}
+
+	void add(const Observables& obs) {
+		series[0].add(obs.V);
+		series[1].add(obs.A);
+		series[2].add(obs.R);
+		series[3].add(obs.R2);
+		series[4].add(obs.R3);
+		series[5].add(obs.R4);
+	}
+
+	static void writeHeader(FILE* out) {
+		fprintf(out, "# cycle");
+		for (int i = 0; i < Count; i++) fprintf(out, "\t%s\t%s.err\t%s.jack\t%s.tau\t%s.neff", name(i), name(i), name(i), name(i), name(i));
+		fprintf(out, "\n");
+	}
+
+	void write(FILE* out, int cycle) const {
+		fprintf(out, "%d", cycle);
+		for (const BinningSeries& s : series) {
+			fprintf(out, "\t%.10g\t%.4g\t%.4g\t%.4g\t%.1f", s.mean(), s.error(), s.jackknifeError(), s.tau(), s.effectiveSamples());
+		}
+		fprintf(out, "\n");
+		fflush(out);
+	}
+
+	// Bits of the observables in a comma separated list like "V,A,R2"; unknown names are reported and skipped
+	static int maskOf(const std::string& list) {
+		int mask = 0;
+		std::stringstream names(list);
+		std::string item;
+		while (std::getline(names, item, ',')) {
+			int i = 0;
+			while (i < Count && item != name(i)) i++;
+			if (i < Count) mask |= 1 << i;
+			else if (!item.empty()) fprintf(stderr, "Unknown observable %s in targetobs\n", item.c_str());
+		}
+		return mask;
+	}
+
+	// Largest relative error of the observables in mask
+	double worstRelativeError(int mask) const {
+		double worst = 0;
+		for (int i = 0; i < Count; i++) {
+			if (!(mask & (1 << i))) continue;
+			const double rel = series[i].relativeError();
+			if (!(rel <= worst)) worst = rel; // NaN (too few samples) counts as worst
+		}
+		return worst;
+	}
+
+	// Every observable in mask has minCount samples, enough of them that the binning
+	// levels reach past tau_int (N_eff >= 2 BinningMinBlocks), and a relative error <= target
+	bool reached(int mask, double target, long minCount) const {
+		for (int i = 0; i < Count; i++) {
+			if (!(mask & (1 << i))) continue;
+			const BinningSeries& s = series[i];
+			if (s.count() < minCount || s.effectiveSamples() < 2 * BinningMinBlocks) return false;
+		}
+		return worstRelativeError(mask) <= target;
+	}
+
+	void print() const {
+		printf("# observable\tmean\terror\tjackknife\ttau_int\tN_eff\tN\n");
+		for (int i = 0; i < Count; i++) {
+			const BinningSeries& s = series[i];
+			printf("%s\t%.10g\t%.4g\t%.4g\t%.4g\t%.1f\t%ld\n", name(i), s.mean(), s.error(), s.jackknifeError(), s.tau(), s.effectiveSamples(), s.count());
+		}
+	}
+};
+
+#endif
@@ -7,10 +7,6 @@
 #endif
 
 
-#define AbsMaxFacexId 100000
-#define AbsMaxCubexId 100000
-
-
 #include <numeric>
 
 #include <iostream>
@@ -18,28 +14,8 @@
 
 #include "random.h"
 
-
-int seed;
-int A;
-int V;
-
-double epsilon;
-double lambda ;
-double alpha;
-
-int steps ;
-int thermal;
-int sweeps ;
-
-double meanV;
-int window;
-
-int startsize;
-   
-
-std::string name;
-
 #include "config.h"
+#include "params.h"
 #include "ball.h"
 //#include "action.h"
 #include "initialize.h"
@@ -56,7 +32,13 @@ std::string name;
 #include "checks.h"
 
 #include "measure.h"
+#include "checkpoint.h"
+#include "compact.h"
+#include "clone.h"
 #include "mc.h"
+#include "rejection_free.h"
+#include "tempering.h"
+#include "simulation.h"
 
 
 #endif
@@ -19,17 +19,28 @@
 
 bool Ball:: performGrow() {
 
-	std::pair<int, Face*> deltaNB;
+	std::pair<int, Face> deltaNB;
 
 	// Cache nextFaceBId to avoid repeated member access
 	const int cachedNextFaceBId = nextFaceBId;
-	if(cachedNextFaceBId-1 == 100000-2) return false;
+	countProposal(MoveGrow);
+	if(!hasCapacity()) {
+		noteRule(RuleCapacity);
+		countChecked(MoveGrow, -1);
+		return false;
+	}
 	
-	deltaNB = CheckValidGrow(GetBoundaryFace(uniform_int(cachedNextFaceBId)));
+	deltaNB = CheckValidGrow(GetBoundaryFace(uniform_int(rng, cachedNextFaceBId)));
+	countChecked(MoveGrow, deltaNB.first);
 	
 	if(deltaNB.first == -1) return false;
 		
-	if(getActionDiffGrow((double)deltaNB.first)) growCube(deltaNB.second);
+	if(getActionDiffGrow((double)deltaNB.first)) {
+		growCube(deltaNB.second);
+		bucketsValid = false; // cached move classes are stale now
+		countMetropolis(MoveGrow, deltaNB.first, true);
+	}
+	else countMetropolis(MoveGrow, deltaNB.first, false);
 
 
 	return true;
@@ -39,41 +50,47 @@ bool Ball:: performGrow() {
 
 
 
-std::pair<int, Face*> Ball::CheckValidGrow(Face* boundaryFace) {
+std::pair<int, Face> Ball::CheckValidGrow(Face boundaryFace) {
+	const MoveTables& tables = moveTables();
 
-//	printf("####################### CHECK VALIDATE GROW #######################\n");	
+	Cube oldCube = boundaryFace.getCube();
+	const int d = Vector3::axisIndex(boundaryFace.getVector());
+	const uint32_t key = tables.growKey(oldCube.getMask(), d);
 
-	
-    Cube* oldCube = boundaryFace->getCube();
+	// A cube on top of the grow site rotates the point of view: take the full walk
+	const uint32_t layer = (key >> 4) & 15;
+	for (int i = 0; i < 4; i++) {
+		if (!(layer & (1u << i))) continue;
+		Cube sideCube = oldCube.getNeighbor(tables.growBits[d][4+i]);
+		if (sideCube.getMask() & (1u << tables.topBits[d][i])) return CheckValidGrowWalk(boundaryFace);
+	}
 
-    Vector3 direction = boundaryFace->getVector(); // Get the direction of the boundary cube
-    
-    // Cache orthogonals array - reused multiple times
-    auto orthogonals = direction.getOrthogonal(); // 4 orthogonal directions (no allocation)
-	
-//	printf("BoundaryFace of CUBE %d: \n",oldCube->getId());
-//	direction.printCoord();
-//	printf("OCD good\n");
-
-    Cube * sideCubes_below[4] =  {nullptr};
-	Cube * cornerCubes_below[4] =  {nullptr};
-	Cube * sideCubes_layer[4] =  {nullptr};
-	Cube * cornerCubes_layer[4] =  {nullptr};
-	Cube * sideCubes_above[4] =  {nullptr};
-	Cube * cornerCubes_above[4] =  {nullptr};
-	Cube * topCube = nullptr;
-    
-	Cube * tempCube = nullptr;
-	Face * tempFace = nullptr;
-	Face * sideFace = nullptr;
-    
+	const int8_t growClass = tables.grow[key];
+	if (growClass == GrowInvalid) {
+		noteRule(static_cast<MoveRule>(tables.growRule[key]));
+		return std::make_pair(-1, boundaryFace);
+	}
+	if (growClass == GrowValid) return std::make_pair(4, boundaryFace); // no side layer: dNB = 4
+
+	return CheckValidGrowWalk(boundaryFace);
+}
+
+
+// Reference implementation walking the neighbour grid, used for the
+// configurations the lookup table cannot decide on its own.
+std::pair<int, Face> Ball::CheckValidGrowWalk(Face boundaryFace) {
+
+    Cube oldCube = boundaryFace.getCube();
+    int d = Vector3::axisIndex(boundaryFace.getVector()); // Get the direction of the boundary cube
+    const DirectionFrame& frame = DirectionFrames[d];
+
+	Cube sideCubes_layer[4];
+	Cube topCube;
 
     for(int i = 0 ; i <4 ; i++) {
-		sideCubes_below[i] = oldCube->getNeighbor(orthogonals[i]);
-		sideCubes_layer[i] = oldCube->getNeighbor(orthogonals[i]+direction);
+		sideCubes_layer[i] = oldCube.getNeighbor(frame.sideUp[i]);
 		
-		if(sideCubes_layer[i] && !topCube) topCube = sideCubes_layer[i]->getNeighbor(direction+orthogonals[i]*-1);	
-			
+		if(sideCubes_layer[i] && !topCube) topCube = sideCubes_layer[i].getNeighbor(frame.sideUp[(i+2)%4]); // d - o_i
     }
 	
 //	########################################################
@@ -81,50 +98,49 @@ std::pair<int, Face*> Ball::CheckValidGrow(Face* boundaryFace) {
 //	########################################################
    	
 	if(topCube) {
+		noteRotated();
 		
-		for(int i = 0 ; i < 4 ; i++) if(!oldCube->getNeighbor(direction+orthogonals[i]) && topCube->getNeighbor(direction*-1+orthogonals[i])) return std::make_pair(-1, boundaryFace);
+		for(int i = 0 ; i < 4 ; i++) if(!sideCubes_layer[i] && topCube.getNeighbor(frame.sideDown[i])) { noteRule(RuleEdgeSide); return std::make_pair(-1, boundaryFace); }
 		
-		if(sideCubes_layer[0] && !sideCubes_layer[2]) boundaryFace = sideCubes_layer[0]->getFace(orthogonals[2]);
-		else if(sideCubes_layer[2] && !sideCubes_layer[0]) boundaryFace = sideCubes_layer[2]->getFace(orthogonals[0]);
-		else if(sideCubes_layer[1] && !sideCubes_layer[3]) boundaryFace = sideCubes_layer[1]->getFace(orthogonals[3]);
-		else if(sideCubes_layer[3] && !sideCubes_layer[1]) boundaryFace = sideCubes_layer[3]->getFace(orthogonals[1]);
-		else return std::make_pair(-1, boundaryFace);
+		if(sideCubes_layer[0] && !sideCubes_layer[2]) boundaryFace = sideCubes_layer[0].getFaceAt(frame.sideAxis[2]);
+		else if(sideCubes_layer[2] && !sideCubes_layer[0]) boundaryFace = sideCubes_layer[2].getFaceAt(frame.sideAxis[0]);
+		else if(sideCubes_layer[1] && !sideCubes_layer[3]) boundaryFace = sideCubes_layer[1].getFaceAt(frame.sideAxis[3]);
+		else if(sideCubes_layer[3] && !sideCubes_layer[1]) boundaryFace = sideCubes_layer[3].getFaceAt(frame.sideAxis[1]);
+		else { noteRule(RuleRotation); return std::make_pair(-1, boundaryFace); }
     	
-    	direction = boundaryFace->getVector(); 
-    	orthogonals = direction.getOrthogonal(); // recompute orthogonals for new direction
-		oldCube = boundaryFace->getCube(); // reset the oldCube
-
+    	d = Vector3::axisIndex(boundaryFace.getVector());
 	}
-    
-    // Reset local neighbor caches (avoid out-of-bounds writes on [4]).
-    for (int i = 0; i < 4; i++) {
-        sideCubes_below[i] = nullptr;
-        sideCubes_layer[i] = nullptr;
-        sideCubes_above[i] = nullptr;
-        cornerCubes_below[i] = nullptr;
-        cornerCubes_layer[i] = nullptr;
-        cornerCubes_above[i] = nullptr;
-    }
-    
-    
-    Face * adjacentFaces[4] = {nullptr};
-    topCube = nullptr;
-	
-//	########################################################
-// ROTATE THE POINT OF VIEW If topCube
-//	########################################################
+
+	return dispatchDirection(d, [&](auto direction) { return CheckValidGrowGrid<decltype(direction)::value>(boundaryFace); });
+}
+
+
+// The grid part of CheckValidGrowWalk for a face pointing along D (after any rotation).
+// -o_i is o_{i+2}, so every offset is one of the DirectionFrame entries.
+template<int D> std::pair<int, Face> Ball::CheckValidGrowGrid(Face boundaryFace) {
+	static constexpr DirectionFrame F = makeDirectionFrame(D);
+
+	Cube oldCube = boundaryFace.getCube();
+
+    Cube sideCubes_below[4];
+	Cube cornerCubes_below[4];
+	Cube sideCubes_layer[4];
+	Cube cornerCubes_layer[4];
+	Cube sideCubes_above[4];
+	Cube cornerCubes_above[4];
+
 //	########################################################
 // SET UP THE NEIGHBOUR GRID
 //	########################################################
 
 	for(int i = 0 ; i < 4 ; i++) {
-		sideCubes_below[i] = oldCube->getNeighbor(orthogonals[i]);
-		sideCubes_layer[i] = oldCube->getNeighbor(orthogonals[i]+direction);
-		cornerCubes_below[i] = oldCube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]);
-		cornerCubes_layer[i] = oldCube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+direction);
+		sideCubes_below[i] = oldCube.getNeighbor(F.side[i]);
+		sideCubes_layer[i] = oldCube.getNeighbor(F.sideUp[i]);
+		cornerCubes_below[i] = oldCube.getNeighbor(F.corner[i]);
+		cornerCubes_layer[i] = oldCube.getNeighbor(F.cornerUp[i]);
 		
-		if(sideCubes_layer[i]) sideCubes_above[i] = sideCubes_layer[i]->getNeighbor(direction);
-		if(cornerCubes_layer[i]) cornerCubes_above[i] = cornerCubes_layer[i]->getNeighbor(direction);	
+		if(sideCubes_layer[i]) sideCubes_above[i] = sideCubes_layer[i].getNeighbor(F.above);
+		if(cornerCubes_layer[i]) cornerCubes_above[i] = cornerCubes_layer[i].getNeighbor(F.above);	
 		
     } // simple adjacencies
 
@@ -132,215 +148,175 @@ std::pair<int, Face*> Ball::CheckValidGrow(Face* boundaryFace) {
 	for(int i = 0 ; i < 4 ; i++) {
     	if(sideCubes_layer[i]) {
     		
-    		if(!cornerCubes_above[i]) cornerCubes_above[i] = sideCubes_layer[i]->getNeighbor(orthogonals[(i+1)%4]+ direction);
-    		if(!cornerCubes_above[(i+3)%4]) cornerCubes_above[(i+3)%4] = sideCubes_layer[i]->getNeighbor(orthogonals[(i+3)%4] + direction);
-
-    		if(!sideCubes_above[(i+1)%4]) sideCubes_above[(i+1)%4] = sideCubes_layer[i]->getNeighbor(orthogonals[(i+1)%4] + orthogonals[i]*-1 + direction);
-      		if(!sideCubes_above[(i+3)%4]) sideCubes_above[(i+3)%4] = sideCubes_layer[i]->getNeighbor(orthogonals[(i+3)%4] + orthogonals[i]*-1 + direction);
+    		if(!cornerCubes_above[i]) cornerCubes_above[i] = sideCubes_layer[i].getNeighbor(F.sideUp[(i+1)%4]);
+    		if(!cornerCubes_above[(i+3)%4]) cornerCubes_above[(i+3)%4] = sideCubes_layer[i].getNeighbor(F.sideUp[(i+3)%4]);
 
-//    		if(!cornerCubes_above[i]) cornerCubes_above[i] = sideCubes_layer[i]->getNeighbor(orthogonals[(i+1)%4]);
+    		if(!sideCubes_above[(i+1)%4]) sideCubes_above[(i+1)%4] = sideCubes_layer[i].getNeighbor(F.cornerUp[(i+1)%4]); // o_{i+1} - o_i + d
+      		if(!sideCubes_above[(i+3)%4]) sideCubes_above[(i+3)%4] = sideCubes_layer[i].getNeighbor(F.cornerUp[(i+2)%4]); // o_{i+3} - o_i + d
     	}    
     }
     
-    
-	
 	for(int i = 0 ; i <4 ; i++) {	
 
 		if(sideCubes_above[i] && !cornerCubes_above[i]) {
-			cornerCubes_above[i] = sideCubes_above[i]->getNeighbor(orthogonals[(i+1)%4]);
+			cornerCubes_above[i] = sideCubes_above[i].getNeighbor(F.side[(i+1)%4]);
 			
-			if(cornerCubes_above[i] && !sideCubes_above[(i+1)%4]) if(cornerCubes_above[i]->getNeighbor(orthogonals[i]*-1)) return std::make_pair(-1, boundaryFace); //disagreement in connection, don't grow
+			if(cornerCubes_above[i] && !sideCubes_above[(i+1)%4]) if(cornerCubes_above[i].getNeighbor(F.side[(i+2)%4])) { noteRule(RuleSecondShell); return std::make_pair(-1, boundaryFace); } //disagreement in connection, don't grow
 		}
 
 		if(sideCubes_above[i] && !cornerCubes_above[(i+3)%4]) {
-			cornerCubes_above[(i+3)%4] = sideCubes_above[i]->getNeighbor(orthogonals[(i+3)%4]);
+			cornerCubes_above[(i+3)%4] = sideCubes_above[i].getNeighbor(F.side[(i+3)%4]);
 			
-			if(cornerCubes_above[(i+3)%4] && !sideCubes_above[(i+3)%4]) if(cornerCubes_above[(i+3)%4]->getNeighbor(orthogonals[i]*-1)) return std::make_pair(-1, boundaryFace); //disagreement in connection, don't grow
+			if(cornerCubes_above[(i+3)%4] && !sideCubes_above[(i+3)%4]) if(cornerCubes_above[(i+3)%4].getNeighbor(F.side[(i+2)%4])) { noteRule(RuleSecondShell); return std::make_pair(-1, boundaryFace); } //disagreement in connection, don't grow
 				
 		}
 	
-		if(cornerCubes_above[i] && !sideCubes_above[i]) if(cornerCubes_above[i]->getNeighbor(orthogonals[(i+1)%4]*-1)) return std::make_pair(-1, boundaryFace);  //disagreement in connection, don't grow
-		if(cornerCubes_above[i] && !sideCubes_above[(i+1)%4]) if(cornerCubes_above[i]->getNeighbor(orthogonals[i]*-1)) return std::make_pair(-1, boundaryFace);  //disagreement in connection, don't grow
+		if(cornerCubes_above[i] && !sideCubes_above[i]) if(cornerCubes_above[i].getNeighbor(F.side[(i+3)%4])) { noteRule(RuleSecondShell); return std::make_pair(-1, boundaryFace); }  //disagreement in connection, don't grow
+		if(cornerCubes_above[i] && !sideCubes_above[(i+1)%4]) if(cornerCubes_above[i].getNeighbor(F.side[(i+2)%4])) { noteRule(RuleSecondShell); return std::make_pair(-1, boundaryFace); }  //disagreement in connection, don't grow
 		
 	}	
 
-	for(int i = 0 ; i < 4 ; i++) {				
-		if(sideCubes_layer[i]) adjacentFaces[i] = sideCubes_layer[i]->getFace(orthogonals[i]*-1);
-		else if(sideCubes_below[i]) adjacentFaces[i] = sideCubes_below[i]->getFace(direction);
-		else adjacentFaces[i] = oldCube->getFace(orthogonals[i]); //adjacent Boundary Faces
-	}
-	
-
 //	########################################################
 // THE NEIGHBOUR GRID SET UP 
 //	########################################################
 	
-
-	
 	for(int i = 0 ; i < 4 ; i++) {	
-		if(sideCubes_above[i] && !sideCubes_layer[i]) return std::make_pair(-1, boundaryFace); // avoid edge connection
-		
-//		if(cornerCubes_layer[i] && !sideCubes_layer[i] ) return std::make_pair(-1, boundaryFace); // avoid edge connection	
-//		if(cornerCubes_layer[i] && !sideCubes_layer[(i+1)%4] ) return std::make_pair(-1, boundaryFace); // avoid edge connection
+		if(sideCubes_above[i] && !sideCubes_layer[i]) { noteRule(RuleEdgeSide); return std::make_pair(-1, boundaryFace); } // avoid edge connection
 		
-		if(cornerCubes_layer[i] && !(sideCubes_layer[i] || sideCubes_layer[(i+1)%4]) ) return std::make_pair(-1, boundaryFace); // avoid edge connection
+		if(cornerCubes_layer[i] && !(sideCubes_layer[i] || sideCubes_layer[(i+1)%4]) ) { noteRule(RuleEdgeCorner); return std::make_pair(-1, boundaryFace); } // avoid edge connection
 
-//		if(cornerCubes_above[i] && !( (sideCubes_layer[i]) && (sideCubes_above[i]) ) ) return std::make_pair(-1, boundaryFace);
-//		if(cornerCubes_above[i] && !( (sideCubes_layer[(i+1)%4]) && (sideCubes_above[(i+1)%4]) ) ) return std::make_pair(-1, boundaryFace);
-		
-		if(cornerCubes_above[i] && (!( (sideCubes_layer[(i+1)%4]) && (sideCubes_above[(i+1)%4]) ) ||!( (sideCubes_layer[i]) && (sideCubes_above[i]) ) ) ) return std::make_pair(-1, boundaryFace);
+		if(cornerCubes_above[i] && (!( (sideCubes_layer[(i+1)%4]) && (sideCubes_above[(i+1)%4]) ) ||!( (sideCubes_layer[i]) && (sideCubes_above[i]) ) ) ) { noteRule(RuleEdgeCorner); return std::make_pair(-1, boundaryFace); }
 		
-		
-		
-		if( sideCubes_layer[i] &&  sideCubes_layer[(i+2)%4] && !(sideCubes_below[i] && sideCubes_below[(i+2)%4]) )  return std::make_pair(-1, boundaryFace);
+		if( sideCubes_layer[i] &&  sideCubes_layer[(i+2)%4] && !(sideCubes_below[i] && sideCubes_below[(i+2)%4]) ) { noteRule(RuleTopology); return std::make_pair(-1, boundaryFace); }
 	}
-  	
-  
-	//printf(" ############ in Validate CONNECTIONS after checking ###############  \n");
-	 
-/*
-	for(int i = 0 ; i < 4 ; i++) {
-   		if(sideCubes_below[i]) printf("sb %d\t%d\n",i,sideCubes_below[i]->getId());
-   		if(sideCubes_layer[i]) printf("sl %d\t%d\n",i,sideCubes_layer[i]->getId());
-   		if(sideCubes_above[i]) printf("sa %d\t%d\n",i,sideCubes_above[i]->getId());
-   		if(cornerCubes_below[i]) printf("cb %d\t%d\n",i,cornerCubes_below[i]->getId());
-   		if(cornerCubes_layer[i]) printf("cl %d\t%d\n",i,cornerCubes_layer[i]->getId());
-   		if(cornerCubes_above[i]) printf("ca %d\t%d\n",i,cornerCubes_above[i]->getId());
-   	}
- */ 			
-
 
  	int sumACA = 0;
  	for(int i = 0 ; i < 4 ; i++) if(sideCubes_layer[i]) sumACA++;
  	
  	int dNB  = 4 - 2*sumACA;
  	
- 	
     return std::make_pair(dNB, boundaryFace); // Return the number of new faces and sum of adjacent cubes above
 }
 
 
 
-void Ball::growCube(Face* boundaryFace) {
+void Ball::growCube(Face boundaryFace) {
+	dispatchDirection(Vector3::axisIndex(boundaryFace.getVector()), [&](auto direction) { growCubeAlong<decltype(direction)::value>(boundaryFace); });
+}
 
+// Glue a new cube onto boundaryFace, which points along D
+template<int D> void Ball::growCubeAlong(Face boundaryFace) {
+	static constexpr DirectionFrame F = makeDirectionFrame(D);
 
-    Cube* oldCube = boundaryFace->getCube(); //cube of the boundary Face
-    Cube* newCube = createCube(); // create a new cube
+    Cube oldCube = boundaryFace.getCube(); //cube of the boundary Face
+    Cube newCube = createCube(); // create a new cube
     
-	Cube * sideCubes_below[4] =  {nullptr};
-	Cube * cornerCubes_below[4] =  {nullptr};
-	Cube * sideCubes_layer[4] =  {nullptr};
-	Cube * cornerCubes_layer[4] =  {nullptr};
-	Cube * sideCubes_above[4] =  {nullptr};
-	Cube * cornerCubes_above[4] =  {nullptr};
-
-	Face* newFaces[5] = {nullptr};
-	Face * adjacentFaces[4] = {nullptr};
-	Face * sideFaces[4] = {nullptr};
-	Face * topFace = nullptr;
+	Cube sideCubes_below[4];
+	Cube cornerCubes_below[4];
+	Cube sideCubes_layer[4];
+	Cube cornerCubes_layer[4];
+	Cube sideCubes_above[4];
+	Cube cornerCubes_above[4];
+
+	Face newFaces[5];
+	Face adjacentFaces[4];
+	Face sideFaces[4];
+	Face topFace;
 	
-	Face * tempFace = nullptr;
+	Face tempFace;
 	
 	int newFaceCounter = 0;
 	int dNB = 5;
 	
-	Vector3 direction = boundaryFace->getVector(); // Set the new cube adjacent to the boundary face
-	newCube->setVector(oldCube->getVector() + direction); // set the coordinate of the old cube
-	// Cache orthogonals array - reused multiple times
-	const auto orthogonals = direction.getOrthogonal(); // 4 orthogonal directions (no allocation)
+	placeCube(newCube, oldCube.getVector() + Vector3::axisFromIndex(D)); // set the coordinate of the new cube
 	
 	for(int i = 0 ; i < 4 ; i++) {
 				
-		sideCubes_below[i] = oldCube->getNeighbor(orthogonals[i]);
-		sideCubes_layer[i] = oldCube->getNeighbor(orthogonals[i]+direction);
+		sideCubes_below[i] = oldCube.getNeighbor(F.side[i]);
+		sideCubes_layer[i] = oldCube.getNeighbor(F.sideUp[i]);
 		
 		if(sideCubes_layer[i]) dNB--; 
 		
-		cornerCubes_below[i] = oldCube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]);
-		cornerCubes_layer[i] = oldCube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+direction);
+		cornerCubes_below[i] = oldCube.getNeighbor(F.corner[i]);
+		cornerCubes_layer[i] = oldCube.getNeighbor(F.cornerUp[i]);
 		
-		if(sideCubes_layer[i]) sideCubes_above[i] = sideCubes_layer[i]->getNeighbor(direction);
-		if(cornerCubes_layer[i]) cornerCubes_above[i] = cornerCubes_layer[i]->getNeighbor(direction);	
+		if(sideCubes_layer[i]) sideCubes_above[i] = sideCubes_layer[i].getNeighbor(F.above);
+		if(cornerCubes_layer[i]) cornerCubes_above[i] = cornerCubes_layer[i].getNeighbor(F.above);	
 		
     } // simple adjacencies
 	
 	for(int i = 0 ; i < dNB ; i++) newFaces[i] = createFace(); // create deltaNB new faces
 	
 	for(int i = 0 ; i <4 ; i++) {
-		if(sideCubes_above[i] && !cornerCubes_above[i]) {cornerCubes_above[i] = sideCubes_above[i]->getNeighbor(orthogonals[(i+1)%4]);}
-		if(sideCubes_above[i] && !cornerCubes_above[(i+3)%4]) {cornerCubes_above[(i+3)%4] = sideCubes_above[i]->getNeighbor(orthogonals[(i+1)%4]*-1);};
+		if(sideCubes_above[i] && !cornerCubes_above[i]) {cornerCubes_above[i] = sideCubes_above[i].getNeighbor(F.side[(i+1)%4]);}
+		if(sideCubes_above[i] && !cornerCubes_above[(i+3)%4]) {cornerCubes_above[(i+3)%4] = sideCubes_above[i].getNeighbor(F.side[(i+3)%4]);};
 	}	
 	
-	
 	for(int i = 0 ; i < 4 ; i++) {				
-		if(sideCubes_layer[i]) adjacentFaces[i] = sideCubes_layer[i]->getFace(orthogonals[i]*-1);
-		else if(sideCubes_below[i]) adjacentFaces[i] = sideCubes_below[i]->getFace(direction);
-		else adjacentFaces[i] = oldCube->getFace(orthogonals[i]); //adjacent Boundary Faces
+		if(sideCubes_layer[i]) adjacentFaces[i] = sideCubes_layer[i].getFaceAt(F.sideAxis[(i+2)%4]);
+		else if(sideCubes_below[i]) adjacentFaces[i] = sideCubes_below[i].getFaceAt(F.upAxis);
+		else adjacentFaces[i] = oldCube.getFaceAt(F.sideAxis[i]); //adjacent Boundary Faces
 	}	
 
-	newCube->setFace(direction * -1, boundaryFace); //glue the boundary to the new cube
-	boundaryFace->setCube(direction, newCube); //glue the new Cube to the boundary
-	setCubeCubeNeighbor(oldCube,newCube,direction); //set them adjacent
-	setNewCubeBFacePair(newCube,newFaces[dNB-1],direction); // set top face
-
+	newCube.setFaceAt(F.downAxis, boundaryFace); //glue the boundary to the new cube
+	boundaryFace.setCubeAt(F.upAxis, newCube); //glue the new Cube to the boundary
+	setCubeCubeNeighbor(oldCube,newCube,F.above); //set them adjacent
+	setNewCubeBFacePair(newCube,newFaces[dNB-1],F.upAxis); // set top face
 
 	for(int i = 0 ; i < 4 ; i++) {
 
-		if(cornerCubes_below[i]) setCubeCubeNeighbor(newCube,cornerCubes_below[i],orthogonals[i]+orthogonals[(i+1)%4]+direction*-1);
-		if(cornerCubes_layer[i]) setCubeCubeNeighbor(newCube,cornerCubes_layer[i],orthogonals[i]+orthogonals[(i+1)%4]);
-		if(cornerCubes_above[i]) setCubeCubeNeighbor(newCube,cornerCubes_above[i],orthogonals[i]+orthogonals[(i+1)%4]+direction);
-		if(sideCubes_above[i]) setCubeCubeNeighbor(newCube,sideCubes_above[i],orthogonals[i]+direction);
-		if(sideCubes_below[i]) setCubeCubeNeighbor(newCube,sideCubes_below[i],orthogonals[i]+direction*-1);
+		if(cornerCubes_below[i]) setCubeCubeNeighbor(newCube,cornerCubes_below[i],F.cornerDown[i]);
+		if(cornerCubes_layer[i]) setCubeCubeNeighbor(newCube,cornerCubes_layer[i],F.corner[i]);
+		if(cornerCubes_above[i]) setCubeCubeNeighbor(newCube,cornerCubes_above[i],F.cornerUp[i]);
+		if(sideCubes_above[i]) setCubeCubeNeighbor(newCube,sideCubes_above[i],F.sideUp[i]);
+		if(sideCubes_below[i]) setCubeCubeNeighbor(newCube,sideCubes_below[i],F.sideDown[i]);
 		
-		if(sideCubes_layer[i]) setCubeFaceNeighbor(newCube,sideCubes_layer[i],adjacentFaces[i],orthogonals[i]); // set new cube and side cube adjacent
-		else setNewCubeBFacePair(newCube,newFaces[newFaceCounter++],orthogonals[i]); // set a new face to the new cube
+		if(sideCubes_layer[i]) setCubeFaceNeighbor(newCube,sideCubes_layer[i],adjacentFaces[i],F.sideAxis[i]); // set new cube and side cube adjacent
+		else setNewCubeBFacePair(newCube,newFaces[newFaceCounter++],F.sideAxis[i]); // set a new face to the new cube
 		
 	}
-	for(int i = 0 ; i <4 ; i++) sideFaces[i] = newCube->getFace(orthogonals[i]); // get side Faces (new or old)
-	topFace = newCube->getFace(direction); //get topFace
+	for(int i = 0 ; i <4 ; i++) sideFaces[i] = newCube.getFaceAt(F.sideAxis[i]); // get side Faces (new or old)
+	topFace = newCube.getFaceAt(F.upAxis); //get topFace
 		
 	// ADJACENCIES are SET, now SET BOUNDARIES
 	
-	for(int i = 0 ; i < 4 ; i++) adjacentFaces[i] = boundaryFace->getAdjacent(orthogonals[i]);
+	for(int i = 0 ; i < 4 ; i++) adjacentFaces[i] = boundaryFace.getAdjacentAt(F.sideAxis[i]);
 	
 	//Treat the down direction (in case no adjacent cube)
 	for(int i = 0 ; i < 4 ; i++) {
-		if(!sideCubes_layer[i] && !sideCubes_below[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],direction * - 1,direction);
-		else if(!sideCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],direction * - 1,orthogonals[i] * -1);
-		//else{}	
+		if(!sideCubes_layer[i] && !sideCubes_below[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],F.downAxis,F.upAxis);
+		else if(!sideCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],F.downAxis,F.sideAxis[(i+2)%4]);
 	}
 	
 	//Treat the side direction
 	for(int i = 0 ; i < 4 ; i++) {
 		if(!sideCubes_layer[i]) { //if no adjacentCUBE
 			 
-			if(!sideCubes_layer[(i+1)%4]) setFaceFaceAdjacent(sideFaces[i],sideFaces[(i+1)%4],orthogonals[(i+1)%4],orthogonals[i]);
-			else if(sideCubes_layer[(i+1)%4]) {
-				tempFace = adjacentFaces[(i+1)%4]->getAdjacent(orthogonals[i]);
+			if(!sideCubes_layer[(i+1)%4]) setFaceFaceAdjacent(sideFaces[i],sideFaces[(i+1)%4],F.sideAxis[(i+1)%4],F.sideAxis[i]);
+			else {
+				tempFace = adjacentFaces[(i+1)%4].getAdjacentAt(F.sideAxis[i]);
 				
-				if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],tempFace,orthogonals[(i+1)%4],orthogonals[i] *-1);
-				else setFaceFaceAdjacent(sideFaces[i],tempFace,orthogonals[(i+1)%4],orthogonals[(i+1)%4]*-1);
+				if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],tempFace,F.sideAxis[(i+1)%4],F.sideAxis[(i+2)%4]);
+				else setFaceFaceAdjacent(sideFaces[i],tempFace,F.sideAxis[(i+1)%4],F.sideAxis[(i+3)%4]);
 			}
-			//else {}
 		}
 		else if(!sideCubes_layer[(i+1)%4]) {
-			tempFace = adjacentFaces[i]->getAdjacent(orthogonals[(i+1)%4]);
+			tempFace = adjacentFaces[i].getAdjacentAt(F.sideAxis[(i+1)%4]);
 			
-			if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[(i+1)%4],tempFace,orthogonals[i],orthogonals[(i+1)%4]*-1);
-			else setFaceFaceAdjacent(sideFaces[(i+1)%4],tempFace,orthogonals[i],orthogonals[i]*-1);		
+			if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[(i+1)%4],tempFace,F.sideAxis[i],F.sideAxis[(i+3)%4]);
+			else setFaceFaceAdjacent(sideFaces[(i+1)%4],tempFace,F.sideAxis[i],F.sideAxis[(i+2)%4]);		
 		}
-		//else {}
 	}
 	
 	//treat the top direction
 	
 	for(int i = 0 ; i < 4 ; i++) {
-		if(!sideCubes_layer[i]) setFaceFaceAdjacent(topFace,sideFaces[i],orthogonals[i],direction);
+		if(!sideCubes_layer[i]) setFaceFaceAdjacent(topFace,sideFaces[i],F.sideAxis[i],F.upAxis);
 		else {
-			tempFace = sideFaces[i]->getAdjacent(direction);
+			tempFace = sideFaces[i].getAdjacentAt(F.upAxis);
 			
-			if(sideCubes_above[i]) setFaceFaceAdjacent(topFace,tempFace,orthogonals[i],direction * -1);
-			else setFaceFaceAdjacent(topFace,tempFace,orthogonals[i],orthogonals[i] * -1);
+			if(sideCubes_above[i]) setFaceFaceAdjacent(topFace,tempFace,F.sideAxis[i],F.downAxis);
+			else setFaceFaceAdjacent(topFace,tempFace,F.sideAxis[i],F.sideAxis[(i+2)%4]);
 		}
 	}
 		
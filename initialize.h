@@ -2,150 +2,401 @@
 #ifndef INITIALIZE_H
 #define INITIALIZE_H
 
+#include <array>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include "ball.h"
 
+// Key of a coordinate in the hash from coordinate to cube
+static inline uint64_t coordinateKey(const Vector3& v) {
+	const uint64_t bias = 1 << 20;
+	return (static_cast<uint64_t>(v.x + bias) & 0x1fffff) | ((static_cast<uint64_t>(v.y + bias) & 0x1fffff) << 21) | ((static_cast<uint64_t>(v.z + bias) & 0x1fffff) << 42);
+}
+
+// Whether the occupied octants around a vertex (bit ox + 2 oy + 4 oz) leave the
+// boundary a disk there: occupied and empty octants each face-connected. This
+// rules out cubes touching only along an edge or at a corner.
+static bool manifoldVertex(int mask) {
+	static const std::array<bool, 256> table = [] {
+		std::array<bool, 256> t{};
+		auto connected = [](int set) {
+			if (set == 0) return true;
+			int seen = set & -set, last = 0;
+			while (seen != last) {
+				last = seen;
+				for (int o = 0; o < 8; o++) {
+					if (seen & (1 << o)) seen |= set & ((1 << (o ^ 1)) | (1 << (o ^ 2)) | (1 << (o ^ 4)));
+				}
+			}
+			return seen == set;
+		};
+		for (int m = 0; m < 256; m++) t[m] = connected(m) && connected(~m & 0xff);
+		return t;
+	}();
+	return table[mask];
+}
+
+// Hash from coordinate to position in a list of cubes
+typedef std::unordered_map<uint64_t, int> CoordinateIndex;
+
+static inline int findCube(const CoordinateIndex& index, const Vector3& v) {
+	auto it = index.find(coordinateKey(v));
+	return it == index.end() ? -1 : it->second;
+}
+
+// Index the cubes of a list; false, with the position in dup, if two share a coordinate
+static bool indexShape(const std::vector<Vector3>& coords, CoordinateIndex& index, long& dup) {
+	index.clear();
+	index.reserve(2 * coords.size());
+	for (int id = 0; id < static_cast<int>(coords.size()); id++) {
+		if (!index.emplace(coordinateKey(coords[id]), id).second) { dup = id; return false; }
+	}
+	return true;
+}
+
+// Why the indexed cubes are not a valid start ball (nullptr if they are, with the
+// number of boundary faces), `value` saying where or how much: the boundary must
+// be manifold at every vertex and a sphere (Euler characteristic V - F = 2 of the
+// boundary surface, whose edges number 2F), the cubes face-connected
+static const char* shapeProblem(const std::vector<Vector3>& coords, const CoordinateIndex& index, long& value, long& boundaryFaces) {
+	const long cubes = static_cast<long>(coords.size());
+	if (cubes == 0) { value = 0; return "no cubes"; }
+	auto find = [&index](const Vector3& v) { return findCube(index, v); };
+
+	long boundaryVertices = 0;
+	boundaryFaces = 0;
+	std::unordered_set<uint64_t> vertices;
+	vertices.reserve(2 * coords.size());
+	for (int id = 0; id < cubes; id++) {
+		const Vector3& v = coords[id];
+		for (int axis = 0; axis < 6; axis++) {
+			if (find(v + Vector3::axisFromIndex(axis)) < 0) boundaryFaces++;
+		}
+		for (int corner = 0; corner < 8; corner++) {
+			const Vector3 vertex = v + Vector3(corner & 1, (corner >> 1) & 1, corner >> 2);
+			if (!vertices.insert(coordinateKey(vertex)).second) continue;
+			int mask = 0;
+			for (int o = 0; o < 8; o++) {
+				if (find(vertex + Vector3((o & 1) - 1, ((o >> 1) & 1) - 1, (o >> 2) - 1)) >= 0) mask |= 1 << o;
+			}
+			if (!manifoldVertex(mask)) { value = id; return "cubes touching only along an edge or at a corner, e.g. at cube"; }
+			if (mask != 0xff) boundaryVertices++;
+		}
+	}
+	if (boundaryVertices - boundaryFaces != 2) { value = boundaryVertices - boundaryFaces; return "boundary is not a sphere (handles or cavities), Euler characteristic"; }
+
+	std::vector<int> stack{0};
+	std::vector<char> reached(cubes, 0);
+	reached[0] = 1;
+	long reachedCount = 1;
+	while (!stack.empty()) {
+		const Vector3 v = coords[stack.back()];
+		stack.pop_back();
+		for (int axis = 0; axis < 6; axis++) {
+			const int w = find(v + Vector3::axisFromIndex(axis));
+			if (w >= 0 && !reached[w]) { reached[w] = 1; reachedCount++; stack.push_back(w); }
+		}
+	}
+	if (reachedCount != cubes) { value = reachedCount; return "cubes not face-connected, cubes reached from the first"; }
+	return nullptr;
+}
+
+// Cube coordinates of a CubeDensity-<name>.out file (lines "id x y z", cdensity 1),
+// in the order of the file; lines starting with # are skipped
+static bool readCubeDensity(const std::string& filename, std::vector<Vector3>& coords) {
+	FILE* in = fopen(filename.c_str(), "r");
+	if (!in) {
+		printf("Cannot open start shape %s\n", filename.c_str());
+		return false;
+	}
+	char line[256];
+	int id, x, y, z;
+	while (fgets(line, sizeof(line), in)) {
+		if (line[0] == '#') continue;
+		if (sscanf(line, "%d %d %d %d", &id, &x, &y, &z) == 4) coords.emplace_back(x, y, z);
+	}
+	fclose(in);
+	return true;
+}
+
+// Cube coordinates of a voxel mask: "nx ny nz", then nx*ny*nz values (x fastest,
+// then y, then z), a cube wherever the value is not 0
+static bool readVoxelMask(const std::string& filename, std::vector<Vector3>& coords) {
+	FILE* in = fopen(filename.c_str(), "r");
+	if (!in) {
+		printf("Cannot open start mask %s\n", filename.c_str());
+		return false;
+	}
+	int nx, ny, nz, value;
+	bool ok = fscanf(in, "%d %d %d", &nx, &ny, &nz) == 3 && nx > 0 && ny > 0 && nz > 0;
+	for (int z = 0; ok && z < nz; z++) {
+		for (int y = 0; ok && y < ny; y++) {
+			for (int x = 0; ok && x < nx; x++) {
+				ok = fscanf(in, "%d", &value) == 1;
+				if (ok && value != 0) coords.emplace_back(x, y, z);
+			}
+		}
+	}
+	fclose(in);
+	if (!ok) printf("Start mask %s: expected \"nx ny nz\" and nx*ny*nz values\n", filename.c_str());
+	return ok;
+}
+
+// Whether a new cube touching the ball through the faces in mask (bit = axis)
+// is glued on along a disk: contact faces and free faces each connected on the
+// cube's surface, neither empty. Opposite faces or a ring of four would make a
+// handle, all six close a cavity.
+static bool diskContact(int mask) {
+	static const std::array<bool, 64> table = [] {
+		std::array<bool, 64> t{};
+		auto connected = [](int set) {
+			int seen = set & -set, last = 0;
+			while (seen != last) {
+				last = seen;
+				for (int a = 0; a < 6; a++) {
+					if (seen & (1 << a)) seen |= set & ~(1 << ((a + 3) % 6));
+				}
+			}
+			return seen == set;
+		};
+		for (int m = 1; m < 63; m++) t[m] = connected(m) && connected(~m & 63);
+		return t;
+	}();
+	return table[mask];
+}
+
+// Make the cubes of a shape file a valid start shape. A CubeDensity file of a
+// run lists cubes that overlap in space, touch along edges or at corners and
+// close loops, none of which a single embedded ball has. So the coordinates are
+// taken as a set (duplicates merged) and the ball is grown through it from the
+// first cube, breadth first: a cube joins when it is glued on along a disk and
+// keeps every vertex manifold, as the grow move would. A cube refused now is
+// tried again when a face neighbour joins; those that never fit are dropped.
+// A file that already is a valid ball is taken as it is.
+static void regularizeShape(std::vector<Vector3>& coords, const char* source) {
+	if (coords.empty()) return;
+	CoordinateIndex index;
+	long value, boundaryFaces;
+	if (indexShape(coords, index, value) && !shapeProblem(coords, index, value, boundaryFaces)) return;
+
+	// 0 in the file, 1 in the ball, 2 copied to kept
+	std::unordered_map<uint64_t, char> state;
+	state.reserve(2 * coords.size());
+	for (const Vector3& v : coords) state.emplace(coordinateKey(v), 0);
+	const long read = static_cast<long>(coords.size()), distinct = static_cast<long>(state.size());
+
+	auto inBall = [&](const Vector3& v) {
+		auto it = state.find(coordinateKey(v));
+		return it != state.end() && it->second == 1;
+	};
+	auto fits = [&](const Vector3& v) {
+		int contact = 0;
+		for (int axis = 0; axis < 6; axis++) {
+			if (inBall(v + Vector3::axisFromIndex(axis))) contact |= 1 << axis;
+		}
+		if (!diskContact(contact)) return false;
+		for (int corner = 0; corner < 8; corner++) {
+			const Vector3 vertex = v + Vector3(corner & 1, (corner >> 1) & 1, corner >> 2);
+			int mask = 0;
+			for (int o = 0; o < 8; o++) {
+				const Vector3 w = vertex + Vector3((o & 1) - 1, ((o >> 1) & 1) - 1, (o >> 2) - 1);
+				if (w == v || inBall(w)) mask |= 1 << o;
+			}
+			if (!manifoldVertex(mask)) return false;
+		}
+		return true;
+	};
+
+	std::deque<Vector3> queue;
+	state[coordinateKey(coords[0])] = 1;
+	queue.push_back(coords[0]);
+	long joined = 1;
+	while (!queue.empty()) {
+		const Vector3 v = queue.front();
+		queue.pop_front();
+		for (int axis = 0; axis < 6; axis++) {
+			const Vector3 w = v + Vector3::axisFromIndex(axis);
+			auto it = state.find(coordinateKey(w));
+			if (it == state.end() || it->second == 1 || !fits(w)) continue;
+			it->second = 1;
+			joined++;
+			queue.push_back(w);
+		}
+	}
+
+	std::vector<Vector3> kept;
+	kept.reserve(joined);
+	for (const Vector3& v : coords) {
+		auto it = state.find(coordinateKey(v));
+		if (it->second == 1) { kept.push_back(v); it->second = 2; }
+	}
+	if (read != joined) {
+		printf("%s: %ld cubes, %ld overlapping merged, %ld not fitting into one ball dropped: starting from %ld cubes\n",
+		       source, read, read - distinct, distinct - joined, joined);
+	}
+	coords.swap(kept);
+}
+
+// Cubes of the start shape file of a run (startdensity or startmask), read and made a
+// valid ball; nullptr, reported, if the file cannot be read
+static std::shared_ptr<const std::vector<Vector3>> readStartShape(const SimulationParams& p) {
+	std::vector<Vector3> coords;
+	const std::string& file = !p.startdensity.empty() ? p.startdensity : p.startmask;
+	if (!p.startdensity.empty() ? !readCubeDensity(file, coords) : !readVoxelMask(file, coords)) return nullptr;
+	regularizeShape(coords, file.c_str());
+	return std::make_shared<const std::vector<Vector3>>(std::move(coords));
+}
+
+// Check the start of a run before any ball is built: read the start shape file once
+// (unless the context has its cubes already, e.g. shared by a sweep) and check it, or
+// the startsize block, against maxcubes / maxfaces. False, with a message, if no ball
+// can be built; the caller decides what to do about it. Every Ball(context) of the
+// run then builds from the cached cubes.
+static bool prepareStart(SimulationContext& context) {
+	if (context.startChecked) return true;
+	const SimulationParams& p = context.params;
+	const std::string& file = !p.startdensity.empty() ? p.startdensity : p.startmask;
+
+	long cubes, faces;
+	if (p.startShape()) {
+		if (!context.startCubes) context.startCubes = readStartShape(p);
+		if (!context.startCubes) return false;
+
+		const std::vector<Vector3>& coords = *context.startCubes;
+		CoordinateIndex index;
+		long value = 0, boundaryFaces = 0;
+		if (!indexShape(coords, index, value)) {
+			printf("%s: two cubes at the same coordinate, e.g. cube %ld\n", file.c_str(), value);
+			return false;
+		}
+		if (const char* problem = shapeProblem(coords, index, value, boundaryFaces)) {
+			printf("%s: %s (%ld)\n", file.c_str(), problem, value);
+			return false;
+		}
+		cubes = static_cast<long>(coords.size());
+		faces = (6 * cubes + boundaryFaces) / 2;
+	}
+	else {
+		const long N = std::max(1, p.startsize);
+		cubes = N * N * N;
+		faces = 3 * N * N * (N + 1);
+	}
+	if (cubes > p.maxcubes || faces > p.maxfaces) {
+		const std::string start = p.startShape() ? "start shape " + file : "startsize " + std::to_string(p.startsize);
+		printf("%s needs %ld cubes and %ld faces: more than maxcubes %d / maxfaces %d\n", start.c_str(), cubes, faces, p.maxcubes, p.maxfaces);
+		return false;
+	}
+	context.startChecked = true;
+	return true;
+}
+
 void Ball::Initialize() {
+	const SimulationParams& p = context->params;
+	// The drivers (main, sweep, tempering) call prepareStart() first and handle a failure
+	if (!prepareStart(*context)) std::exit(EXIT_FAILURE);
 
-	for (int i = 0; i < AbsMaxCubexId; i++) { availableCubeIds[i] = i ; }
-	for (int i = 0; i < AbsMaxFacexId; i++) { availableFaceIds[i] = i ; }
-	for (int i = 0; i < AbsMaxFacexId; i++) { availableFaceBIds[i] = i ; }
-	
-	
-	cubeMap.resize(AbsMaxCubexId);
-	faceMap.resize(AbsMaxFacexId);
-	BoundaryFaces.resize(AbsMaxFacexId);
+	// The id maps start empty and grow with the ball
+	cubeMap.clear();
+	faceMap.clear();
+	BoundaryFaces.clear();
+
+	// Reserve slabs for the target size up front (F = (6V + A)/2), so the growth phase does not reallocate
+	const long start = p.startShape() ? static_cast<long>(context->startCubes->size()) : static_cast<long>(p.startsize) * p.startsize * p.startsize;
+	const long cubes = std::min<long>(p.maxcubes, std::max<long>(start, p.V));
+	const long faces = std::min<long>(p.maxfaces, 3 * cubes + std::max(p.A, 0) / 2 + 6);
+	store.reset();
+	store.reserve(cubes, faces);
 
 	nextCubeId = 0;
     nextFaceId = 0;
     nextFaceBId = 0;
-	
-	
-    Cube* cube = createCube();
-    cube->setVector(0,0,0);
-    
-    // CREATE FIRST CUBE //
-    
-    Vector3 px(1, 0, 0); // create the base vector set
-    Vector3 py(0, 1, 0);
-    Vector3 pz(0, 0, 1);
-    Vector3 mx(-1, 0, 0);
-    Vector3 my(0, -1, 0);
-    Vector3 mz(0, 0, -1); // create the base vector set
-    
-    Face* face_px = createFace(); // Create faces
-    Face* face_py = createFace();
-    Face* face_pz = createFace();
-    Face* face_mx = createFace();
-    Face* face_my = createFace();
-    Face* face_mz = createFace(); // Create faces
-
-    cube->setFace(px,face_px); //add faces to the cube
-    cube->setFace(py,face_py);
-    cube->setFace(pz,face_pz);
-    cube->setFace(mx,face_mx);
-    cube->setFace(my,face_my);
-    cube->setFace(mz,face_mz); //add faces to the cube
-    
-    face_px->setCube(px * -1, cube); //add cube to the faces (opposite direction)
-    face_py->setCube(py * -1, cube); 
-    face_pz->setCube(pz * -1, cube); 
-    face_mx->setCube(mx * -1, cube); 
-    face_my->setCube(my * -1, cube); 
-    face_mz->setCube(mz * -1, cube); //add cube to the faces (opposite direction)
-    
-    face_px->setVector(px); //set direction of boundary faces
-    face_py->setVector(py);
-    face_pz->setVector(pz);
-    face_mx->setVector(mx);
-    face_my->setVector(my);
-    face_mz->setVector(mz); //set direction of boundary faces
-   
-    face_px->setAdjacent(py,face_py); //make faces to be adjacent
-    face_px->setAdjacent(my,face_my);
-    face_px->setAdjacent(pz,face_pz);
-    face_px->setAdjacent(mz,face_mz);
-    
-    face_py->setAdjacent(px,face_px);
-    face_py->setAdjacent(mx,face_mx);
-    face_py->setAdjacent(pz,face_pz);
-    face_py->setAdjacent(mz,face_mz);
-    
-    face_pz->setAdjacent(py,face_py);
-    face_pz->setAdjacent(my,face_my);
-    face_pz->setAdjacent(px,face_px);
-    face_pz->setAdjacent(mx,face_mx); //make faces to be adjacent
-
-	face_mx->setAdjacent(my,face_my); //make faces to be adjacent
-    face_mx->setAdjacent(py,face_py);
-    face_mx->setAdjacent(mz,face_mz);
-    face_mx->setAdjacent(pz,face_pz);
-    
-    face_my->setAdjacent(mx,face_mx);
-    face_my->setAdjacent(px,face_px);
-    face_my->setAdjacent(mz,face_mz);
-    face_my->setAdjacent(pz,face_pz);
-    
-    face_mz->setAdjacent(my,face_my);
-    face_mz->setAdjacent(py,face_py);
-    face_mz->setAdjacent(mx,face_mx);
-    face_mz->setAdjacent(px,face_px); //make faces to be adjacent
-    
-     
-    // Initialize larger cube if startsize > 1 //
-        
-    initializeCubicStructure(startsize);
-    
-    printCubulation();
-    
-    
-    
+
+    // The starting shape (a single cube for startsize 1)
+    if (p.startShape()) initializeFromCoordinates(*context->startCubes);
+    else initializeCubicStructure(std::max(1, p.startsize));
 }
+
+// The starting N x N x N block with corner (0,0,0), cubes by id x fastest. For
+// N = 1 this is the same single cube (faces +x,+y,+z,-x,-y,-z = ids 0..5) as before.
 void Ball::initializeCubicStructure(int N) {
-    if (N <= 1) return;
-
-    // Assuming cubeMap[0] is already placed as the first cube at the origin.
-    for (int z = 0; z < N; z++) {
-        for (int y = 0; y < N; y++) {
-            for (int x = 0; x < N; x++) {
-                if (x == 0 && y == 0 && z == 0) continue; // The first cube is already placed.
-				
-				printf("(x y z): (%d %d %d) ALL CUBES: %d: \n",x,y,z, nextCubeId);
-				
-
-                Vector3 direction;
-                // Determine direction based on layer (z), row (y), and column (x).
-                if (x == 0) {
-                    if (y == 0) {
-                        // Start of a new layer (excluding the first layer).
-                        if (z > 0) {
-                            int baseCubeIndex = (z - 1) * N * N; // Base cube of the previous layer.
-                            direction = Vector3(0, 0, 1); // Moving up to start a new layer.
-
-                            growCube(cubeMap[baseCubeIndex]->getFace(direction));
-                        }
-                    } 
-                    else {
-                        // Start of a new row (excluding the first row of each layer).
-                        int baseCubeIndex = z * N * N + (y - 1) * N; // End cube of the previous row in the current layer.
-                       
-                        direction = Vector3(0, 1, 0); // Moving forward to start a new row.
-                 
-                        growCube(cubeMap[baseCubeIndex]->getFace(direction));
-                    }
-                } 
-                else {
-                    // Continuing a row.
-                    int baseCubeIndex = z * N * N + y * N + (x - 1); // Previous cube in the current row.
-                   
-                    direction = Vector3(1, 0, 0); // Moving right in the current row.
- 
-                    growCube(cubeMap[baseCubeIndex]->getFace(direction));
-                }
-            }
-        }
-    }
+	std::vector<Vector3> coords;
+	coords.reserve(static_cast<size_t>(N) * N * N);
+	for (int z = 0; z < N; z++) {
+		for (int y = 0; y < N; y++) {
+			for (int x = 0; x < N; x++) coords.emplace_back(x, y, z);
+		}
+	}
+	initializeFromCoordinates(coords);
 }
 
+// Build the ball from a list of cube coordinates in one pass: cubes in list order,
+// their 26-neighbourhoods, the faces (a face shared with a neighbour that came
+// earlier in the list is reused), then the adjacency of the boundary faces. The
+// face next to (cube c, direction d) along a is the -a face of c + a + d if that
+// cube is there (concave edge), the d face of c + a if that one is (flat), the a
+// face of c otherwise (convex). The shape must be a ball with a manifold boundary,
+// what the grow/shrink moves keep, and fit maxcubes / maxfaces: prepareStart()
+// has checked that.
+void Ball::initializeFromCoordinates(const std::vector<Vector3>& coords) {
+	const long cubes = static_cast<long>(coords.size());
+	CoordinateIndex index;
+	long dup;
+	indexShape(coords, index, dup);
+	auto find = [&index](const Vector3& v) { return findCube(index, v); };
+
+	for (int id = 0; id < cubes; id++) placeCube(createCube(), coords[id]);
+
+	for (int id = 0; id < cubes; id++) {
+		Cube cube = cubeAt(cubeMap[id]);
+		const Vector3 v = cube.getVector();
+
+		for (int idx = 0; idx < 27; idx++) {
+			if (idx == 13) continue;
+			const int w = find(v + Vector3::neighborFromIndex(idx));
+			if (w >= 0) cube.setNeighborAt(idx, cubeAt(cubeMap[w]));
+		}
+
+		for (int axis = 0; axis < 6; axis++) {
+			const int w = find(v + Vector3::axisFromIndex(axis));
+			if (w >= 0 && w < id) { // shared with an earlier neighbour, which made it already
+				Face face = cubeAt(cubeMap[w]).getFaceAt(oppositeAxis(axis));
+				cube.setFaceAt(axis, face);
+				face.setCubeAt(oppositeAxis(axis), cube);
+				continue;
+			}
+
+			Face face = faceAt(store.allocFaceSlot());
+			face.setId(nextFaceId++);
+			faceMap.push_back(face.getSlot());
+			cube.setFaceAt(axis, face);
+			face.setCubeAt(oppositeAxis(axis), cube);
+			if (w < 0) {
+				face.setVector(Vector3::axisFromIndex(axis));
+				AddFaceBoundary(face);
+			}
+		}
+	}
+
+	for (int bId = 0; bId < nextFaceBId; bId++) {
+		Face face = GetBoundaryFace(bId);
+		const int d = Vector3::axisIndex(face.getVector());
+		Cube cube = face.getCube();
+		const Vector3 v = cube.getVector();
+
+		for (int axis = 0; axis < 6; axis++) {
+			if (axis == d || axis == oppositeAxis(d)) continue;
+			const Vector3 w = v + Vector3::axisFromIndex(axis);
+			const int concave = find(w + Vector3::axisFromIndex(d));
+			const int flat = find(w);
+			if (concave >= 0) face.setAdjacentAt(axis, cubeAt(cubeMap[concave]).getFaceAt(oppositeAxis(axis)));
+			else if (flat >= 0) face.setAdjacentAt(axis, cubeAt(cubeMap[flat]).getFaceAt(d));
+			else face.setAdjacentAt(axis, cube.getFaceAt(axis));
+		}
+	}
+}
+
+
 
-	
 #endif
@@ -0,0 +1,149 @@
+#pragma once
+#ifndef LOOKUP_H
+#define LOOKUP_H
+
+/*
+ * Occupancy-mask lookup tables for the grow/shrink validity checks.
+ *
+ * Every cube keeps a 26-bit mask of its occupied neighbour slots (cube.h).
+ * For a face direction d with orthogonals o_0..o_3 the checks only look at a
+ * few of these bits, which are gathered into a 12-bit key in the canonical
+ * frame of d:
+ *
+ *   grow   : bits 0-3 o_i (side below), 4-7 o_i+d (side layer), 8-11 o_i+o_{i+1}+d (corner layer)
+ *   shrink : bits 0-3 o_i (side layer), 4-7 o_i-d (side below), 8-11 o_i+o_{i+1}   (corner layer)
+ *
+ * The shrink rules only depend on the cube's own neighbourhood, so the table
+ * gives the exact answer. The grow rules also read cubes in the second shell
+ * (reached through the side layer), so the grow table resolves the local rules
+ * and flags the configurations that still need the full neighbour walk.
+ */
+
+#include <array>
+#include <cstdint>
+#include "cube.h"
+
+enum GrowClass : int8_t { GrowInvalid = 0, GrowValid = 1, GrowWalk = 2 };
+
+// Why a move is invalid, for the move statistics (stats.h)
+enum MoveRule : int8_t {
+	RuleNone = 0,
+	RuleCapacity,    // maxcubes/maxfaces reached
+	RuleEdgeCorner,  // a corner cube would only share an edge
+	RuleEdgeSide,    // a side cube would only share an edge
+	RuleTopology,    // opposite side cubes, the move would change the topology
+	RuleSecondShell, // the neighbour grid disagrees in the second shell
+	RuleRotation,    // no free side to rotate the point of view to
+	RuleLastCube,    // shrink of the last cube
+	RuleCount
+};
+
+static const char* const MoveRuleNames[RuleCount] = {"none", "capacity", "edge-corner", "edge-side", "topology", "second-shell", "rotation", "last-cube"};
+
+struct MoveTables {
+	// Neighbour slot indices (Vector3::neighborIndex) of the key bits, per face direction.
+	std::array<std::array<uint8_t, 12>, 6> growBits;
+	std::array<std::array<uint8_t, 12>, 6> shrinkBits;
+
+	// Slot of the cube on top of the grow site seen from side layer cube i: d - o_i.
+	std::array<std::array<uint8_t, 4>, 6> topBits;
+	// Slot of the cube below a boundary face: -d.
+	std::array<uint8_t, 6> bottomBit;
+	// Axis index of orthogonal i of direction d.
+	std::array<std::array<int8_t, 4>, 6> orthogonalAxis;
+
+	std::array<int8_t, 4096> grow;   // GrowClass
+	std::array<int8_t, 4096> shrink; // dNB, or -1 for an invalid shrink
+	std::array<int8_t, 16> shrinkRotation; // orthogonal index of the rotated face, or -1
+	std::array<int8_t, 4096> growRule;   // MoveRule of a GrowInvalid key
+	std::array<int8_t, 4096> shrinkRule; // MoveRule of an invalid shrink key
+
+	MoveTables() {
+		for (int d = 0; d < 6; d++) {
+			const Vector3 direction = Vector3::axisFromIndex(d);
+			const auto orthogonals = direction.getOrthogonal();
+
+			bottomBit[d] = Vector3::neighborIndex(direction * -1);
+			for (int i = 0; i < 4; i++) {
+				const Vector3& o = orthogonals[i];
+				const Vector3& o1 = orthogonals[(i+1)%4];
+
+				growBits[d][i] = Vector3::neighborIndex(o);
+				growBits[d][4+i] = Vector3::neighborIndex(o + direction);
+				growBits[d][8+i] = Vector3::neighborIndex(o + o1 + direction);
+
+				shrinkBits[d][i] = Vector3::neighborIndex(o);
+				shrinkBits[d][4+i] = Vector3::neighborIndex(o + direction * -1);
+				shrinkBits[d][8+i] = Vector3::neighborIndex(o + o1);
+
+				topBits[d][i] = Vector3::neighborIndex(direction + o * -1);
+				orthogonalAxis[d][i] = Vector3::axisIndex(o);
+			}
+		}
+
+		for (int key = 0; key < 4096; key++) {
+			bool below[4], layer[4], corner[4];
+			int sumACA = 0;
+			for (int i = 0; i < 4; i++) {
+				below[i] = (key >> i) & 1;
+				layer[i] = (key >> (4+i)) & 1;
+				corner[i] = (key >> (8+i)) & 1;
+			}
+
+			// grow: same local rules as CheckValidGrowWalk (below/layer/corner = side below, side layer, corner layer)
+			int8_t growClass = GrowValid, growReason = RuleNone;
+			for (int i = 0; i < 4; i++) {
+				if (layer[i]) growClass = GrowWalk; // side layer cubes can reach the second shell
+			}
+			for (int i = 0; i < 4; i++) {
+				if (corner[i] && !(layer[i] || layer[(i+1)%4])) { growClass = GrowInvalid; growReason = RuleEdgeCorner; } // avoid edge connection
+				if (layer[i] && layer[(i+2)%4] && !(below[i] && below[(i+2)%4])) { growClass = GrowInvalid; growReason = RuleTopology; }
+			}
+			grow[key] = growClass;
+			growRule[key] = growReason;
+
+			// shrink: here bits 0-3 are the side layer and 4-7 the side below
+			bool sideLayer[4], sideBelow[4];
+			for (int i = 0; i < 4; i++) {
+				sideLayer[i] = below[i];
+				sideBelow[i] = layer[i];
+				if (sideLayer[i]) sumACA++;
+			}
+			int8_t dNB = -4 + 2*sumACA, shrinkReason = RuleNone;
+			for (int i = 0; i < 4; i++) {
+				if (sideLayer[i] && !sideBelow[i]) { dNB = -1; shrinkReason = RuleEdgeSide; } //avoid edge connection
+				if (sideLayer[i] && sideLayer[(i+2)%4] && sumACA == 2 && sideBelow[i] && sideBelow[(i+2)%4]) { dNB = -1; shrinkReason = RuleTopology; } //avoid changing the topology
+				if (sideLayer[i] && sideLayer[(i+1)%4] && !corner[i]) { dNB = -1; shrinkReason = RuleEdgeCorner; } //avoid edge connection
+			}
+			shrink[key] = dNB;
+			shrinkRule[key] = shrinkReason;
+		}
+
+		// Rotate a shrink without a bottom cube towards the free side (CheckValidShrinkWalk).
+		for (int bits = 0; bits < 16; bits++) {
+			const bool t0 = bits & 1, t1 = bits & 2, t2 = bits & 4, t3 = bits & 8;
+			if (t0 && !t2) shrinkRotation[bits] = 2;
+			else if (!t0 && t2) shrinkRotation[bits] = 0;
+			else if (t1 && !t3) shrinkRotation[bits] = 3;
+			else if (!t1 && t3) shrinkRotation[bits] = 1;
+			else shrinkRotation[bits] = -1;
+		}
+	}
+
+	static inline uint32_t gather(uint32_t mask, const std::array<uint8_t, 12>& bits, int count = 12) {
+		uint32_t key = 0;
+		for (int k = 0; k < count; k++) key |= ((mask >> bits[k]) & 1u) << k;
+		return key;
+	}
+
+	uint32_t growKey(uint32_t mask, int d) const { return gather(mask, growBits[d]); }
+	uint32_t shrinkKey(uint32_t mask, int d) const { return gather(mask, shrinkBits[d]); }
+};
+
+// Built once on first use.
+static inline const MoveTables& moveTables() {
+	static const MoveTables tables;
+	return tables;
+}
+
+#endif
@@ -23,87 +23,20 @@ int main(int argc, char* argv[]) {
     ConfigReader cfr;
     cfr.read(fname);
 
-    seed = cfr.getInt("seed");
-    A = cfr.getInt("A");
-    V = cfr.getInt("V");
-    
-    startsize = cfr.getInt("startsize");
-
-    lambda = cfr.getDouble("lambda");
-    alpha = cfr.getDouble("alpha");    
-    epsilon = cfr.getDouble("epsilon");
-
+    // Everything this run needs lives in its context (params.h)
+    SimulationContext context(SimulationParams::fromConfig(cfr));
+    const SimulationParams& params = context.params;
 
-    steps = cfr.getInt("steps");
-    thermal = cfr.getInt("thermal");
-    sweeps = cfr.getInt("sweeps");
-
-    name = cfr.getString("name");
-    
-    
-    printf("seed: %d\n",seed);
-    printf("A: %d\n",A);
-    printf("V: %d\n",V);
-    printf("startSize: %d\n",startsize);
-    printf("epsilon: %g\n",epsilon);
-    printf("Lambda: %g\n",lambda);
-    printf("steps: %d\n",steps);
-    printf("thermal: %d\n",thermal);
-    printf("sweeps: %d\n",sweeps);
-    printf("name: %s\n",name.c_str());
-    
-  
-	setGlobalRNGSeed(seed); // Example seed value
-	
-	printf("######## Create a Ball ############\n");
-	
-    Ball ball; // Assuming Ball's constructor initializes at least one cube.
-    
-    
-    
-    printf("###### START THERMAL: ######\n");
-    
-    
-  	
-  	for(int i = 0 ; i < V; i++) {
-		ball.performGrow();
-		ball.measure();
-    }
-    
-    for(int i = 0 ; i < V; i++) {
-		if(0.5 > uniform_real()) ball.performGrow();
-			else ball.performShrink();	
-		ball.measure();
-    }
-    
-	window = 10;
-    
-    // Cache window division result
-    const int stepsPerWindow = int(steps/window);
-    
-    for(int i = 0 ; i < thermal; i++) {
-		for(int j = 0 ; j < stepsPerWindow; j++) {
-			meanV = 0;
-			for(int k = 0 ; k < window ; k++) {
-				if(0.5 > uniform_real()) ball.performGrow();
-				else ball.performShrink();
-				meanV+=ball.getNextCubeId();
-			}
-		}
-		
-		ball.measure();
-		
-		ball.tuneV();
-    }
+    params.print();
 
+	// A start that cannot be built ends the run here, before any ball exists
+	const bool restart = params.replicas <= 1 && params.fromfile && !params.inname.empty();
+	if (!restart && !prepareStart(context)) return EXIT_FAILURE;
 
-    printf("###### PRINT CONFIGS: ######\n");
-    
-    ball.printConfigs();
-    
+	if(params.replicas > 1) { if (!runTempering(context)) return EXIT_FAILURE; } // Parallel tempering between (lambda, alpha) and (lambdaend, alphaend)
+	else if (!runSimulation(context)) return EXIT_FAILURE;
 		
     printf("###### FINITO ######\n");
 
     return 0;
 }
-
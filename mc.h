@@ -19,9 +19,9 @@
 
 void Ball::tuneV() {
     // Cache window and V to avoid repeated member access
-    const int cachedWindow = window;
-    const int cachedV = V;
-    const double cachedMeanV = meanV;
+    const int cachedWindow = context->window;
+    const int cachedV = context->params.V;
+    const double cachedMeanV = context->meanV;
     
     // Calculate the difference between the current number of cubes and the desired volume
     const double invWindow = 1.0 / static_cast<double>(cachedWindow);
@@ -48,7 +48,7 @@ void Ball::tuneV() {
 void Ball::tuneA() {
     // Cache nextFaceBId and A to avoid repeated member access
     const int cachedNextFaceBId = nextFaceBId;
-    const int cachedA = A;
+    const int cachedA = context->params.A;
     
     // Calculate the difference between the current number of cubes and the desired volume
     const int diff = cachedA - cachedNextFaceBId;
@@ -72,6 +72,51 @@ void Ball::tuneA() {
 
 
 
+// Adaptive tuning (tunemode 1, tune.h) from the cycle means in the context.
+// Returns true once the couplings are frozen.
+bool Ball::tuneCouplings() {
+    SimulationContext& ctx = *context;
+    TuneState& tune = ctx.tune;
+    const SimulationParams& p = ctx.params;
+    if (tune.converged) return true;
+
+    const double steps = static_cast<double>(std::max(1L, ctx.cycleSteps));
+    const double errorV = (p.V - ctx.cycleV / steps) / p.V;
+    const double errorA = (p.A - ctx.cycleA / steps) / p.A;
+
+    lambda += tune.volume.step(errorV, p.tunegain, p.tuneprop, p.tunetol, 0.2);
+    bool held = tune.volume.holds(errorV, p.tunetol, p.tunehold);
+    if (p.tuneAV) {
+        alpha += tune.area.step(errorA, p.tunegain, p.tuneprop, p.tunetol, 1.0);
+        held = tune.area.holds(errorA, p.tunetol, p.tunehold) && held;
+    }
+
+    tune.cycles++;
+    tune.converged = held;
+    return held;
+}
+
+
+// Stationarity test of precision-targeted runs with tunemode 0: the convergence
+// window of the adaptive controller on the cycle means, while tuneV() keeps its fixed steps.
+// A untuned but among the targets has to stop drifting as well.
+bool Ball::holdsTargets() {
+    SimulationContext& ctx = *context;
+    TuneState& tune = ctx.tune;
+    const SimulationParams& p = ctx.params;
+    if (tune.converged) return true;
+
+    const double steps = static_cast<double>(std::max(1L, ctx.cycleSteps));
+    bool held = tune.volume.holds((p.V - ctx.cycleV / steps) / p.V, p.tunetol, p.tunehold);
+    if (p.tuneAV) held = tune.area.holds((p.A - ctx.cycleA / steps) / p.A, p.tunetol, p.tunehold) && held;
+    else if (p.targetmask & (1 << 1)) held = tune.area.steady(ctx.cycleA / steps, p.tunetol, p.tunehold) && held; // A is a target: wait until it stops drifting
+
+    tune.cycles++;
+    tune.converged = held;
+    return held;
+}
+
+
 //var = rand() % 10;
 
 
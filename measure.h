@@ -13,81 +13,112 @@
  * - Optimized measurement loop calculations
  */
 
-void Ball::measure() {
-    
-    char filename[256];
-    		
-    sprintf(filename, "cube-%s.out", name.c_str());
-    
-    // Opening/closing per call is expensive; keep a buffered handle.
-    static FILE* out = nullptr;
-    static std::string openedFor;
-    static int flushCounter = 0;
-    if (!out || openedFor != filename) {
-        if (out) fclose(out);
-        out = fopen(filename, "a");
-        if (!out) {
-            perror("Failed to open file for output");
-            return;
-        }
-        openedFor = filename;
-        setvbuf(out, nullptr, _IOFBF, 1 << 20); // 1MB buffer
+#include <limits>
+
+Observables Ball::measure() {
+
+    const Observables obs = getObservables();
+
+    // Binary records go to the run's background writer (observables.h)
+    if (context->params.binaryout) {
+        ObservableWriter* writer = context->binaryObservables();
+        if (writer) writer->write(obs);
+        return obs;
     }
 
-    // Measure the area of the cubulation
-    // Cache nextFaceBId to avoid repeated member access
-    const int cachedNextFaceBId = nextFaceBId;
-    fprintf(out, "%d\t%d\t", nextCubeId, cachedNextFaceBId);
-
-    // Compute the average coordinate (centroid)
-    double sumx = 0.0, sumy = 0.0, sumz = 0.0;
-    double R = 0.0, r = 0.0;
-    double R2 = 0;
-    double R3 = 0;
-    double R4 = 0;
-    
-    // Cache nextCubeId to avoid repeated member access
-    const int cachedNextCubeId = nextCubeId;
-    const double invN = 1.0 / static_cast<double>(cachedNextCubeId);
-    
-    for (int i = 0; i < cachedNextCubeId; i++) {
-        const Vector3& vec = cubeMap[i]->getVector();
-        sumx += vec.x;
-        sumy += vec.y;
-        sumz += vec.z;
+    // The run keeps the buffered cube-<name>.out handle.
+    FILE* out = context->observablesFile();
+    if (!out) return obs;
+
+    writeObservables(out, obs);
+
+    context->observablesWritten();
+    return obs;
+}
+
+
+// Write one line of observables to an already open file.
+void Ball::measure(FILE* out) { writeObservables(out, getObservables()); }
+
+
+Observables Ball::getObservables() {
+
+    Observables obs;
+
+    // Volume and area of the cubulation
+    obs.V = nextCubeId;
+    obs.A = nextFaceBId;
+
+    // Centroid and R2 come from the running coordinate sums in O(1); the
+    // other moments need a full pass, done on every momentsevery-th call.
+    const bool fullPass = ++measureCount >= context->params.momentsevery;
+    if (!fullPass) {
+        obs.R = obs.R3 = obs.R4 = std::numeric_limits<double>::quiet_NaN();
+        obs.R2 = getR2();
+        obs.lambda = lambda;
+        obs.alpha = alpha;
+        return obs;
     }
-    const double avgx = sumx * invN;
-    const double avgy = sumy * invN;
-    const double avgz = sumz * invN;
-    
-
-    for (int i = 0; i < cachedNextCubeId; i++) {
-       
-        const Vector3& vec = cubeMap[i]->getVector();
-        const double dx = avgx - static_cast<double>(vec.x);
-        const double dy = avgy - static_cast<double>(vec.y);
-        const double dz = avgz - static_cast<double>(vec.z);
-        r = std::sqrt(dx*dx + dy*dy + dz*dz);
-        
-        R += r;
-        R2 += r*r;
-        R3 += r*r*r;
-        R4 += r*r*r*r;
-         
+    measureCount = 0;
+
+    const double invN = 1.0 / static_cast<double>(nextCubeId);
+    const RadiusMoments m = radiusMoments(cubeX.data(), cubeY.data(), cubeZ.data(), nextCubeId,
+                                          sumX * invN, sumY * invN, sumZ * invN);
+
+    obs.R = m.R * invN; // Use cached inverse instead of division
+    obs.R2 = m.R2;
+    obs.R3 = m.R3;
+    obs.R4 = m.R4;
+
+    obs.lambda = lambda;
+    obs.alpha = alpha;
+
+    return obs;
+}
+
+
+// Sum of the squared distances from the centroid, from the running sums:
+// sum |x - c|^2 = sum |x|^2 - |sum x|^2 / N.
+double Ball::getR2() const {
+    const double n = static_cast<double>(nextCubeId);
+    const double sx = static_cast<double>(sumX), sy = static_cast<double>(sumY), sz = static_cast<double>(sumZ);
+    return static_cast<double>(sumSquares) - (sx*sx + sy*sy + sz*sz) / n;
+}
+
+Vector3d Ball::getCentroid() const {
+    const double invN = 1.0 / static_cast<double>(nextCubeId);
+    return Vector3d{sumX * invN, sumY * invN, sumZ * invN};
+}
+
+void Ball::rebuildCoordinates() {
+    sumX = sumY = sumZ = sumSquares = 0;
+    cubeX.resize(nextCubeId); cubeY.resize(nextCubeId); cubeZ.resize(nextCubeId);
+    for (int i = 0; i < nextCubeId; i++) {
+        const Vector3& v = store.cubeCoord[cubeMap[i]];
+        cubeX[i] = v.x; cubeY[i] = v.y; cubeZ[i] = v.z;
+        addCoordinate(v);
     }
-    R *= invN; // Use cached inverse instead of division
+}
 
 
-    fprintf(out, "%g\t", R);
-	fprintf(out, "%g\t", R2);
-	fprintf(out, "%g\t", R3);
-	fprintf(out, "%g\t", R4);
+// One line of the radial histogram: V, then the number of cubes with
+// distance from the centroid in [k, k+1) for k = 0 .. max.
+void Ball::writeRadialHistogram(FILE* out) {
+    const double invN = 1.0 / static_cast<double>(nextCubeId);
+    radialBuffer.resize(nextCubeId);
+    radialDistances(cubeX.data(), cubeY.data(), cubeZ.data(), nextCubeId,
+                    sumX * invN, sumY * invN, sumZ * invN, radialBuffer.data());
 
-    fprintf(out,"%g\t",lambda);
-    fprintf(out,"%g\n",alpha);
+    std::vector<int> counts;
+    for (double r : radialBuffer) {
+        const size_t bin = static_cast<size_t>(r);
+        if (bin >= counts.size()) counts.resize(bin + 1, 0);
+        counts[bin]++;
+    }
 
-    // Periodically flush (avoid paying the cost every call).
-    if ((++flushCounter & 1023) == 0) fflush(out);
+    fprintf(out, "%d", nextCubeId);
+    for (int c : counts) fprintf(out, "\t%d", c);
+    fprintf(out, "\n");
 }
 
 
@@ -6,54 +6,43 @@
 
 
 
-Cube* Ball::createCube() {
-    if (nextCubeId >= AbsMaxCubexId) return nullptr;
-
-    int id = availableCubeIds[nextCubeId];
-    Cube* cube = nullptr;
-    if (!freeCubes.empty()) {
-        cube = freeCubes.back();
-        freeCubes.pop_back();
-        cube->Initialize();
-    } else {
-        cube = new Cube();
-        allocatedCubes.push_back(cube);
-    }
-    cube->setId(id);
-    cubeMap[id] = cube;
+Cube Ball::createCube() {
+    if (nextCubeId >= context->params.maxcubes) return Cube();
+
+    int id = nextCubeId;
+    Cube cube = cubeAt(store.allocCubeSlot());
+    cube.setId(id);
+    cubeMap.push_back(cube.getSlot());
+    cubeX.push_back(0); cubeY.push_back(0); cubeZ.push_back(0);
     nextCubeId++; // Move to the next available ID
     
     return cube;
 }
 
-void Ball::deleteCube(Cube * cube) {
-	int id = cube->getId();
+void Ball::deleteCube(Cube cube) {
+	int id = cube.getId();
 	cubeMap[id] = cubeMap[nextCubeId-1];
 	nextCubeId--;
 	
-	cubeMap[id]->setId(id);
-
-    // Clear the old last slot and recycle the allocation.
-    cubeMap[nextCubeId] = nullptr;
-    freeCubes.push_back(cube);
+	cubeAt(cubeMap[id]).setId(id);
+	cubeX[id] = cubeX[nextCubeId];
+	cubeY[id] = cubeY[nextCubeId];
+	cubeZ[id] = cubeZ[nextCubeId];
+
+    // Drop the old last entry and recycle the storage slot.
+    cubeMap.pop_back();
+    cubeX.pop_back(); cubeY.pop_back(); cubeZ.pop_back();
+    store.freeCubeSlot(cube.getSlot());
 }
 
 
-Face* Ball::createFace() {
-    if (nextFaceId >= AbsMaxFacexId) return nullptr;
-
-    int id = availableFaceIds[nextFaceId];
-    Face* face = nullptr;
-    if (!freeFaces.empty()) {
-        face = freeFaces.back();
-        freeFaces.pop_back();
-        face->Initialize();
-    } else {
-        face = new Face();
-        allocatedFaces.push_back(face);
-    }
-    face->setId(id);
-    faceMap[id] = face;
+Face Ball::createFace() {
+    if (nextFaceId >= context->params.maxfaces) return Face();
+
+    int id = nextFaceId;
+    Face face = faceAt(store.allocFaceSlot());
+    face.setId(id);
+    faceMap.push_back(face.getSlot());
     nextFaceId++; // Move to the next available ID
     
     AddFaceBoundary(face);
@@ -61,56 +50,56 @@ Face* Ball::createFace() {
     return face;
 }
 
-void Ball::deleteFace(Face * face) {
-	int id = face->getId();
+void Ball::deleteFace(Face face) {
+	int id = face.getId();
 	//printf("delete ID: %d/%d\n",id,nextFaceId);
 	faceMap[id] = faceMap[nextFaceId-1];
 	nextFaceId--;
 		
-	faceMap[id]->setId(id);
+	faceAt(faceMap[id]).setId(id);
 
-    faceMap[nextFaceId] = nullptr;
-    freeFaces.push_back(face);
+    faceMap.pop_back();
+    store.freeFaceSlot(face.getSlot());
 }
 
 
 
-Cube* Ball::getCube(int id) const {return cubeMap[id];}
-Face* Ball::getFace(int id) const {return faceMap[id];}
-Face* Ball::getBFace(int id) const {return BoundaryFaces[id];}
+Cube Ball::getCube(int id) {return cubeAt(cubeMap[id]);}
+Face Ball::getFace(int id) {return faceAt(faceMap[id]);}
+Face Ball::getBFace(int id) {return faceAt(BoundaryFaces[id]);}
 
-void Ball::AddFaceBoundary(Face * boundaryFace) {
+void Ball::AddFaceBoundary(Face boundaryFace) {
 
-	BoundaryFaces[nextFaceBId] = boundaryFace;
-	boundaryFace->setBId(nextFaceBId);
+	BoundaryFaces.push_back(boundaryFace.getSlot());
+	boundaryFace.setBId(nextFaceBId);
 	
 	nextFaceBId++;
 }
 
-void Ball::RestoreFaceBoundary(Face * boundaryFace, Vector3 direction) {
+void Ball::RestoreFaceBoundary(Face boundaryFace, Vector3 direction) {
 
-	BoundaryFaces[nextFaceBId] = boundaryFace;
+	BoundaryFaces.push_back(boundaryFace.getSlot());
 	
 	//printf("RESTORED BID IS : %d \n",nextFaceBId);
-	boundaryFace->setBId(nextFaceBId);
+	boundaryFace.setBId(nextFaceBId);
 	
-	boundaryFace->setVector(direction);
+	boundaryFace.setVector(direction);
 	
 	nextFaceBId++;
 }
 
 
 
-void Ball::RemoveFaceBoundary(Face * boundaryFace) {
+void Ball::RemoveFaceBoundary(Face boundaryFace) {
 
-	int bId = boundaryFace->getBId(); 
+	int bId = boundaryFace.getBId(); 
 
 	//printf("REMOVED BID IS : %d next is: %d \n",bId,nextFaceBId - 1);	
 	
 	BoundaryFaces[bId] = BoundaryFaces[nextFaceBId-1];
-	BoundaryFaces[bId]->setBId(bId);
+	faceAt(BoundaryFaces[bId]).setBId(bId);
 		
-	BoundaryFaces[nextFaceBId-1] = nullptr;
+	BoundaryFaces.pop_back();
 	
 	nextFaceBId--;
 }
@@ -0,0 +1,232 @@
+#pragma once
+#ifndef OBSERVABLES_H
+#define OBSERVABLES_H
+
+/*
+ * Binary time series of the measure() observables.
+ *
+ * File layout (native byte order):
+ *   magic "CUBO", uint32 version, uint32 record size, uint32 column count
+ *   per column   : char name[15], char type ('i' = int32, 'f' = float32)
+ *   uint32 length, run parameters as "key value" lines (config file format)
+ *   fixed-size records, one per measurement
+ *
+ * The writer collects records in a block and hands full blocks to a
+ * background thread that writes them, so measure() neither formats text nor
+ * waits for the disk. observables2tsv.cpp turns a file back into the
+ * tab-separated cube-<name>.out columns.
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One measurement, as computed by Ball::getObservables()
+struct Observables {
+	int V;
+	int A;
+	double R, R2, R3, R4;
+	double lambda;
+	double alpha;
+};
+
+// Same line as the text cube-<name>.out has always had.
+static inline void writeObservables(FILE* out, const Observables& obs) {
+	fprintf(out, "%d\t%d\t", obs.V, obs.A);
+	fprintf(out, "%g\t", obs.R);
+	fprintf(out, "%g\t", obs.R2);
+	fprintf(out, "%g\t", obs.R3);
+	fprintf(out, "%g\t", obs.R4);
+	fprintf(out, "%g\t", obs.lambda);
+	fprintf(out, "%g\n", obs.alpha);
+}
+
+
+struct ObservableColumn {
+	char name[15];
+	char type;
+};
+
+static constexpr char ObservableMagic[4] = {'C', 'U', 'B', 'O'};
+static constexpr uint32_t ObservableVersion = 1;
+
+// Binary record; float keeps more digits than the %g text output.
+struct ObservableRecord {
+	int32_t V;
+	int32_t A;
+	float R, R2, R3, R4;
+	float lambda;
+	float alpha;
+
+	static ObservableRecord from(const Observables& obs) {
+		return ObservableRecord{obs.V, obs.A, static_cast<float>(obs.R), static_cast<float>(obs.R2),
+		                        static_cast<float>(obs.R3), static_cast<float>(obs.R4),
+		                        static_cast<float>(obs.lambda), static_cast<float>(obs.alpha)};
+	}
+};
+
+static const ObservableColumn ObservableSchema[] = {
+	{"V", 'i'}, {"A", 'i'}, {"R", 'f'}, {"R2", 'f'}, {"R3", 'f'}, {"R4", 'f'}, {"lambda", 'f'}, {"alpha", 'f'}
+};
+static constexpr uint32_t ObservableColumnCount = sizeof(ObservableSchema) / sizeof(ObservableColumn);
+
+
+// Header of an observables file; also used to check files we append to.
+struct ObservableHeader {
+	uint32_t recordSize = 0;
+	std::vector<ObservableColumn> columns;
+	std::string params;
+
+	bool read(FILE* f) {
+		char magic[4];
+		uint32_t version, count, length;
+		if (fread(magic, 1, 4, f) != 4 || memcmp(magic, ObservableMagic, 4) != 0) return false;
+		if (fread(&version, 4, 1, f) != 1 || version != ObservableVersion) return false;
+		if (fread(&recordSize, 4, 1, f) != 1 || fread(&count, 4, 1, f) != 1 || count > 256) return false;
+		columns.resize(count);
+		if (count && fread(columns.data(), sizeof(ObservableColumn), count, f) != count) return false;
+		if (fread(&length, 4, 1, f) != 1 || length > (1u << 20)) return false;
+		params.assign(length, '\0');
+		return length == 0 || fread(&params[0], 1, length, f) == length;
+	}
+
+	bool write(FILE* f) const {
+		const uint32_t count = static_cast<uint32_t>(columns.size());
+		const uint32_t length = static_cast<uint32_t>(params.size());
+		return fwrite(ObservableMagic, 1, 4, f) == 4 && fwrite(&ObservableVersion, 4, 1, f) == 1
+		    && fwrite(&recordSize, 4, 1, f) == 1 && fwrite(&count, 4, 1, f) == 1
+		    && (count == 0 || fwrite(columns.data(), sizeof(ObservableColumn), count, f) == count)
+		    && fwrite(&length, 4, 1, f) == 1 && (length == 0 || fwrite(params.data(), 1, length, f) == length);
+	}
+
+	// Byte offset of every column inside a record (all columns are 4 bytes wide).
+	std::vector<size_t> offsets() const {
+		std::vector<size_t> result;
+		for (size_t c = 0; c < columns.size(); c++) result.push_back(4 * c);
+		return result;
+	}
+};
+
+
+class ObservableWriter {
+public:
+	static constexpr size_t BlockRecords = 8192;
+
+	ObservableWriter() = default;
+	ObservableWriter(const ObservableWriter&) = delete;
+	ObservableWriter& operator=(const ObservableWriter&) = delete;
+	~ObservableWriter() { close(); }
+
+	bool isOpen() const { return file != nullptr; }
+
+	// Append to filename if it already holds records with this schema, otherwise start a new file.
+	// An existing file with another schema (or no readable header) is kept as <filename>.bak.
+	bool open(const std::string& filename, const std::string& params) {
+		name = filename;
+		failed = false;
+		if (FILE* existing = fopen(filename.c_str(), "rb")) {
+			fseek(existing, 0, SEEK_END);
+			const bool empty = ftell(existing) == 0;
+			rewind(existing);
+			ObservableHeader header;
+			const bool matches = header.read(existing) && header.recordSize == sizeof(ObservableRecord)
+			                  && header.columns.size() == ObservableColumnCount
+			                  && memcmp(header.columns.data(), ObservableSchema, sizeof(ObservableSchema)) == 0;
+			fclose(existing);
+			if (matches) file = fopen(filename.c_str(), "ab");
+			else if (!empty) {
+				const std::string backup = filename + ".bak";
+				if (rename(filename.c_str(), backup.c_str()) != 0) {
+					printf("%s has another record format and cannot be moved to %s, not writing to it\n", filename.c_str(), backup.c_str());
+					return false;
+				}
+				printf("%s has another record format, moved to %s\n", filename.c_str(), backup.c_str());
+			}
+		}
+		if (!file) {
+			file = fopen(filename.c_str(), "wb");
+			if (!file) {
+				perror("Failed to open file for output");
+				return false;
+			}
+			ObservableHeader header;
+			header.recordSize = sizeof(ObservableRecord);
+			header.columns.assign(ObservableSchema, ObservableSchema + ObservableColumnCount);
+			header.params = params;
+			header.write(file);
+		}
+
+		block.reserve(BlockRecords);
+		stop = false;
+		flusher = std::thread(&ObservableWriter::loop, this);
+		return true;
+	}
+
+	void write(const Observables& obs) {
+		block.push_back(ObservableRecord::from(obs));
+		if (block.size() == BlockRecords) submit();
+	}
+
+	// Write what is left and wait for the background thread; false (reported) if a record was lost.
+	bool close() {
+		if (!file) return true;
+		if (!block.empty()) submit();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		wake.notify_all();
+		flusher.join();
+		if (fclose(file) != 0) failed = true;
+		file = nullptr;
+		if (failed) printf("Writing %s failed (disk full?), records are missing\n", name.c_str());
+		return !failed;
+	}
+
+private:
+	FILE* file = nullptr;
+	std::string name;
+	bool failed = false; // a write of the flush thread came up short
+	std::vector<ObservableRecord> block;   // filled by write()
+	std::vector<ObservableRecord> pending; // owned by the flush thread while hasPending
+	bool hasPending = false;
+	bool stop = false;
+	std::thread flusher;
+	std::mutex mutex;
+	std::condition_variable wake, idle;
+
+	// Hand the current block to the flush thread (waits if the previous one is still being written).
+	void submit() {
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [this] { return !hasPending; });
+		std::swap(block, pending);
+		hasPending = true;
+		lock.unlock();
+		wake.notify_one();
+		block.clear();
+	}
+
+	void loop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			wake.wait(lock, [this] { return hasPending || stop; });
+			if (hasPending) {
+				lock.unlock();
+				const bool written = fwrite(pending.data(), sizeof(ObservableRecord), pending.size(), file) == pending.size();
+				lock.lock();
+				if (!written) failed = true;
+				hasPending = false;
+				idle.notify_one();
+			}
+			else if (stop) return;
+		}
+	}
+};
+
+
+#endif
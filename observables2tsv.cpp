@@ -0,0 +1,61 @@
+// Convert a binary observables file (observables.h) to the tab-separated
+// cube-<name>.out format:  observables2tsv cube-<name>.bin > cube-<name>.out
+//
+// Build: g++ -std=c++17 -O2 observables2tsv.cpp -o observables2tsv
+
+#include <cstdio>
+#include <vector>
+#include "observables.h"
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <observables.bin> [--params]\n", argv[0]);
+		return 1;
+	}
+
+	FILE* in = fopen(argv[1], "rb");
+	if (!in) {
+		perror("Failed to open input file");
+		return 1;
+	}
+
+	ObservableHeader header;
+	if (!header.read(in) || header.recordSize != 4 * header.columns.size()) {
+		fprintf(stderr, "%s is not an observables file\n", argv[1]);
+		fclose(in);
+		return 1;
+	}
+
+	// --params prints the run parameters stored in the header instead of the records
+	if (argc > 2 && std::string(argv[2]) == "--params") {
+		fputs(header.params.c_str(), stdout);
+		fclose(in);
+		return 0;
+	}
+
+	const std::vector<size_t> offsets = header.offsets();
+	const size_t columns = header.columns.size();
+	std::vector<char> records(header.recordSize * 4096);
+
+	size_t count;
+	while ((count = fread(records.data(), header.recordSize, 4096, in)) > 0) {
+		for (size_t i = 0; i < count; i++) {
+			const char* record = records.data() + i * header.recordSize;
+			for (size_t c = 0; c < columns; c++) {
+				const char separator = c + 1 < columns ? '\t' : '\n';
+				if (header.columns[c].type == 'i') {
+					int32_t value;
+					memcpy(&value, record + offsets[c], 4);
+					printf("%d%c", value, separator);
+				} else {
+					float value;
+					memcpy(&value, record + offsets[c], 4);
+					printf("%g%c", static_cast<double>(value), separator);
+				}
+			}
+		}
+	}
+
+	fclose(in);
+	return 0;
+}
@@ -0,0 +1,295 @@
+#pragma once
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "cube.h"
+#include "observables.h"
+#include "stats.h"
+#include "tune.h"
+#include "errors.h"
+
+// Parameters of one simulation run, read once from the config file.
+struct SimulationParams {
+	int seed;
+	int A;
+	int V;
+	int startsize;
+	std::string startdensity; // start shape from a CubeDensity file instead of the block (initialize.h)
+	std::string startmask;    // start shape from a voxel mask
+
+	double lambda;
+	double alpha;
+	double epsilon;
+
+	int steps;
+	int thermal;
+	int sweeps;
+
+	std::string name;
+
+	int rejectionfree = 0;
+
+	// Coupling tuning (mc.h, tune.h): 0 = fixed steps every thermal cycle, 1 = adaptive
+	// controller that equilibrates first and freezes the couplings once converged
+	int tunemode = 0;
+	int tuneAV = 0;          // also tune alpha towards A
+	double tunegain = 2.0;   // adaptive: initial coupling step per unit relative error
+	double tuneprop = 10;    // adaptive: weight of the proportional (damping) term
+	double tunetol = 0.005;  // adaptive: relative tolerance of the mean over the last tunehold cycles
+	int tunehold = 40;       // adaptive: cycles in the convergence window (at most 64)
+	int tunecycles = 0;      // adaptive: most equilibration cycles (0 = thermal)
+
+	// Capacity limits; storage grows with the ball up to these
+	int maxcubes = 100000;
+	int maxfaces = 500001; // 5 V + 1 faces at most, so maxcubes is what binds by default
+
+	// 1 = write observables as binary records to cube-<name>.bin (observables.h)
+	int binaryout = 0;
+
+	// Full pass for R, R3, R4 on every momentsevery-th measurement (NaN in between); R2 is always exact
+	int momentsevery = 1;
+
+	// Thermal cycles between slot compactions (compact.h), 0 = never
+	int compactevery = 0;
+
+	// 1 = write a radial histogram per thermal cycle to rhist-<name>.out
+	int rhist = 0;
+
+	// Thermal cycles between lines of stats-<name>.out (stats.h), 0 = never
+	int statsevery = 0;
+
+	// Thermal cycles between lines of errors-<name>.out (errors.h), 0 = never
+	int errorsevery = 0;
+
+	// Precision-targeted runs: equilibrate first, then stop the thermal cycles once the
+	// observables in targetmask (config key targetobs, e.g. V,A,R2) have a relative
+	// error below targeterror; thermal stays the upper limit. 0 = off
+	double targeterror = 0;
+	int targetmask = 1;     // bit i = ObservableErrors::name(i), default V
+	int targetmin = 256;    // fewest measurements before the target can stop the run
+	double walltime = 0;    // seconds after which the run stops and writes its output, 0 = no limit
+
+	// Checkpoint / restart (checkpoint.h)
+	std::string inname;
+	std::string outname;
+	int fromfile = 0;
+	int checkpoint = 0; // thermal cycles between checkpoints, 0 = only at the end
+
+	// Parallel tempering (tempering.h)
+	int replicas = 0;
+	int threads = 0;
+	int swapsteps = 0;
+	double lambdaend = 0;
+	double alphaend = 0;
+	int clonestart = 0; // 1 = grow one replica and start all others from copies of it
+
+	static SimulationParams fromConfig(ConfigReader& cfr) {
+		SimulationParams p;
+
+		p.seed = cfr.getInt("seed");
+		p.A = cfr.getInt("A");
+		p.V = cfr.getInt("V");
+
+		p.startsize = cfr.getInt("startsize");
+		p.startdensity = cfr.has("startdensity") ? cfr.getString("startdensity") : "";
+		p.startmask = cfr.has("startmask") ? cfr.getString("startmask") : "";
+
+		p.lambda = cfr.getDouble("lambda");
+		p.alpha = cfr.getDouble("alpha");
+		p.epsilon = cfr.getDouble("epsilon");
+
+		p.steps = cfr.getInt("steps");
+		p.thermal = cfr.getInt("thermal");
+		p.sweeps = cfr.getInt("sweeps");
+
+		p.name = cfr.getString("name");
+
+		p.rejectionfree = cfr.getInt("rejectionfree", 0);
+		p.tunemode = cfr.getInt("tunemode", 0);
+		p.tuneAV = cfr.getInt("tuneAV", 0);
+		p.tunegain = cfr.getDouble("tunegain", 2.0);
+		p.tuneprop = cfr.getDouble("tuneprop", 10);
+		p.tunetol = cfr.getDouble("tunetol", 0.005);
+		p.tunehold = std::max(2, std::min(TuneWindowMax, cfr.getInt("tunehold", 40)));
+		p.tunecycles = cfr.getInt("tunecycles", 0);
+		p.maxcubes = cfr.getInt("maxcubes", 100000);
+		p.maxfaces = cfr.getInt("maxfaces", 5 * p.maxcubes + 1);
+		p.binaryout = cfr.getInt("binaryout", 0);
+		p.momentsevery = std::max(1, cfr.getInt("momentsevery", 1));
+		p.rhist = cfr.getInt("rhist", 0);
+		p.compactevery = cfr.getInt("compactevery", 0);
+		p.statsevery = cfr.getInt("statsevery", 0);
+		p.errorsevery = cfr.getInt("errorsevery", 0);
+		p.targeterror = cfr.getDouble("targeterror", 0);
+		p.targetmask = cfr.has("targetobs") ? ObservableErrors::maskOf(cfr.getString("targetobs")) : 1;
+		if (p.targetmask == 0) p.targetmask = 1;
+		p.targetmin = cfr.getInt("targetmin", 256);
+		p.walltime = cfr.getDouble("walltime", 0);
+
+		p.inname = cfr.has("inname") ? cfr.getString("inname") : "";
+		p.outname = cfr.has("outname") ? cfr.getString("outname") : "";
+		p.fromfile = cfr.getInt("fromfile", 0);
+		p.checkpoint = cfr.getInt("checkpoint", 0);
+
+		p.replicas = cfr.getInt("replicas", 0);
+		p.threads = cfr.getInt("threads", p.replicas);
+		p.swapsteps = std::max(1, cfr.getInt("swapsteps", p.steps)); // 0 would never finish a cycle
+		p.lambdaend = cfr.getDouble("lambdaend", p.lambda);
+		p.alphaend = cfr.getDouble("alphaend", p.alpha);
+		p.clonestart = cfr.getInt("clonestart", 0);
+
+		return p;
+	}
+
+	// A start shape from a file: the ball starts near its size, so there is no growth phase
+	bool startShape() const { return !startdensity.empty() || !startmask.empty(); }
+
+	void print() const {
+		printf("seed: %d\n",seed);
+		printf("A: %d\n",A);
+		printf("V: %d\n",V);
+		printf("startSize: %d\n",startsize);
+		if (startShape()) printf("start shape: %s\n",!startdensity.empty() ? startdensity.c_str() : startmask.c_str());
+		printf("epsilon: %g\n",epsilon);
+		printf("Lambda: %g\n",lambda);
+		printf("steps: %d\n",steps);
+		printf("thermal: %d\n",thermal);
+		printf("sweeps: %d\n",sweeps);
+		printf("name: %s\n",name.c_str());
+		printf("rejectionfree: %d\n",rejectionfree);
+		if (tunemode) printf("tunemode: %d tuneAV: %d tunegain: %g tuneprop: %g tunetol: %g tunehold: %d\n",tunemode,tuneAV,tunegain,tuneprop,tunetol,tunehold);
+		if (targeterror > 0) printf("targeterror: %g targetmask: %d targetmin: %d\n",targeterror,targetmask,targetmin);
+		if (walltime > 0) printf("walltime: %g s\n",walltime);
+		printf("maxcubes: %d maxfaces: %d\n",maxcubes,maxfaces);
+		if (fromfile) printf("fromfile: %s\n",inname.c_str());
+		if (!outname.empty()) printf("outname: %s\n",outname.c_str());
+		printf("replicas: %d\n",replicas);
+	}
+
+	// The run parameters in config file format, stored in binary output headers
+	std::string toText() const {
+		char text[1024];
+		snprintf(text, sizeof(text),
+		         "seed %d\nA %d\nV %d\nstartsize %d\nlambda %.17g\nalpha %.17g\nepsilon %.17g\n"
+		         "steps %d\nthermal %d\nsweeps %d\nname %s\nrejectionfree %d\nreplicas %d\n",
+		         seed, A, V, startsize, lambda, alpha, epsilon, steps, thermal, sweeps, name.c_str(),
+		         rejectionfree, replicas);
+		return text;
+	}
+};
+
+
+// Everything one run owns besides its balls: the parameters, the tuning
+// accumulators and the observables file. Balls keep a pointer to it, so
+// independent runs in one process do not share any state.
+struct SimulationContext {
+	SimulationParams params;
+
+	// Volume summed over the last window of steps, read by tuneV()
+	double meanV = 0;
+	int window = 10;
+
+	// Volume and boundary area summed over the current thermal cycle, read by tuneCouplings()
+	double cycleV = 0, cycleA = 0;
+	long cycleSteps = 0;
+
+	// Adaptive tuning state, saved in checkpoints
+	TuneState tune;
+
+	// Binning/jackknife analysis of the thermal-cycle measurements (not saved in checkpoints)
+	ObservableErrors errors;
+
+	// Thermal cycles completed, saved in checkpoints
+	int cycle = 0;
+
+	// Cubes of the start shape file (startdensity / startmask), read once by prepareStart()
+	// (initialize.h) and shared by every ball of the run; startChecked once the start fits
+	std::shared_ptr<const std::vector<Vector3>> startCubes;
+	bool startChecked = false;
+
+	// Wall time per phase of the run, written to stats-<name>.out
+	PhaseTimes phases;
+
+	explicit SimulationContext(const SimulationParams& p) : params(p) {}
+	SimulationContext(const SimulationContext&) = delete;
+	SimulationContext& operator=(const SimulationContext&) = delete;
+
+	~SimulationContext() {
+		if (cubeOut) fclose(cubeOut);
+		if (rhistOut) fclose(rhistOut);
+		if (statsOut) fclose(statsOut);
+		if (errorsOut) fclose(errorsOut);
+	}
+
+	// rhist-<name>.out, opened on first use
+	FILE* radialHistogramFile() {
+		if (!rhistOut) {
+			rhistOut = fopen(("rhist-" + params.name + ".out").c_str(), "a");
+			if (!rhistOut) perror("Failed to open file for output");
+		}
+		return rhistOut;
+	}
+
+	// stats-<name>.out, opened on first use; the column header goes into a new file
+	FILE* statsFile() {
+		if (!statsOut) {
+			statsOut = fopen(("stats-" + params.name + ".out").c_str(), "a");
+			if (!statsOut) { perror("Failed to open file for output"); return nullptr; }
+			fseek(statsOut, 0, SEEK_END);
+			if (ftell(statsOut) == 0) writeStatsHeader(statsOut);
+		}
+		return statsOut;
+	}
+
+	// errors-<name>.out, opened on first use; the column header goes into a new file
+	FILE* errorsFile() {
+		if (!errorsOut) {
+			errorsOut = fopen(("errors-" + params.name + ".out").c_str(), "a");
+			if (!errorsOut) { perror("Failed to open file for output"); return nullptr; }
+			fseek(errorsOut, 0, SEEK_END);
+			if (ftell(errorsOut) == 0) ObservableErrors::writeHeader(errorsOut);
+		}
+		return errorsOut;
+	}
+
+	// cube-<name>.bin, opened on first use; records are flushed by a background thread
+	ObservableWriter* binaryObservables() {
+		if (!binaryOut.isOpen() && !binaryOut.open("cube-" + params.name + ".bin", params.toText())) return nullptr;
+		return &binaryOut;
+	}
+
+	// cube-<name>.out, opened on first use with a large buffer
+	FILE* observablesFile() {
+		if (!cubeOut) {
+			char filename[256];
+			sprintf(filename, "cube-%s.out", params.name.c_str());
+			cubeOut = fopen(filename, "a");
+			if (!cubeOut) {
+				perror("Failed to open file for output");
+				return nullptr;
+			}
+			setvbuf(cubeOut, nullptr, _IOFBF, 1 << 20); // 1MB buffer
+		}
+		return cubeOut;
+	}
+
+	// Periodically flush (avoid paying the cost every call).
+	void observablesWritten() { if ((++flushCounter & 1023) == 0) fflush(cubeOut); }
+
+private:
+	FILE* cubeOut = nullptr;
+	FILE* rhistOut = nullptr;
+	FILE* statsOut = nullptr;
+	FILE* errorsOut = nullptr;
+	int flushCounter = 0;
+	ObservableWriter binaryOut;
+};
+
+
+#endif
@@ -17,12 +17,12 @@ void Ball::printCubulation() {
     
     printf("###################   Cubes Information    #####################:\n");
     for (size_t i = 0; i < nextCubeId; ++i) {
-        Cube* cube = cubeMap[i];
+        Cube cube = cubeAt(cubeMap[i]);
         printf("Cube ID: %zu ", i);
-        cube->getVector().printCoord();
+        cube.getVector().printCoord();
         printf("Faces: ");
-        for (Face* f : cube->faces) {
-            if (f) printf("%d ", f->getId());
+        for (Slot f : store.cubeFaces[cube.getSlot()]) {
+            if (f != NoSlot) printf("%d ", faceAt(f).getId());
         }
         printf("\n");
         
@@ -30,53 +30,53 @@ void Ball::printCubulation() {
         printf("Neighbors: ");
         for (int idx = 0; idx < 27; idx++) {
             if (idx == 13) continue;
-            Cube* neighborCube = cube->neighbors[idx];
+            Cube neighborCube = cube.getNeighbor(idx);
             if (!neighborCube) continue;
             const Vector3 dir = Vector3::neighborFromIndex(idx);
-            printf("- %d (%d,%d,%d) ", neighborCube->getId(), dir.x, dir.y, dir.z);
+            printf("- %d (%d,%d,%d) ", neighborCube.getId(), dir.x, dir.y, dir.z);
         }
         printf("\n");
     }
 
     printf("###################   Face Information    #####################:\n");
     for (size_t i = 0; i < nextFaceId; ++i) {
-        Face* face = faceMap[i];
+        Face face = faceAt(faceMap[i]);
         printf("Face ID: %zu Cubes: ", i);
-        for (Cube* c : face->cubes) {
-            if (c) printf("%d ", c->getId());
+        for (Slot c : store.faceCubes[face.getSlot()]) {
+            if (c != NoSlot) printf("%d ", cubeAt(c).getId());
         }
-        printf("Is Boundary: %s ", face->isBoundary ? "Yes" : "No");
+        printf("Is Boundary: %s ", face.getIsBoundary() ? "Yes" : "No");
         printf("Neighbors: ");
-        for (Face* nf : face->neighbors) {
-            if (nf) printf("%d ", nf->getId());
+        for (Slot nf : store.faceNeighbors[face.getSlot()]) {
+            if (nf != NoSlot) printf("%d ", faceAt(nf).getId());
         }
-        face->getVector().printCoord();
+        face.getVector().printCoord();
     }
 
     printf("\n");
     
     printf("###################   Boundary Face Information   ###################:\n");
 	for (size_t i = 0; i < nextFaceBId; ++i) {
-    Face* face = BoundaryFaces[i];
-    if (!face) continue; // Safety check to skip over null pointers
+    Face face = faceAt(BoundaryFaces[i]);
+    if (!face) continue; // Safety check to skip over empty slots
     
     
-    face->printNeighbors();
+    face.printNeighbors();
      
-    printf(" %s ", face->isBoundary ? "Boundary" : "");
+    printf(" %s ", face.getIsBoundary() ? "Boundary" : "");
     printf("Face ID: %zu ", i);
 
     printf("Cubes: ");
-    for (Cube* c : face->cubes) {
-        if (c) printf("%d ", c->getId());
+    for (Slot c : store.faceCubes[face.getSlot()]) {
+        if (c != NoSlot) printf("%d ", cubeAt(c).getId());
     }
    
     printf("Neighbors: [ ");
-    for (Face* neighborFace : face->neighbors) {
-        if (neighborFace) printf("%d ", neighborFace->getId());
+    for (Slot neighborFace : store.faceNeighbors[face.getSlot()]) {
+        if (neighborFace != NoSlot) printf("%d ", faceAt(neighborFace).getId());
     }
     printf("] ");
-    face->getVector().printCoord();
+    face.getVector().printCoord();
 }
 
 	printf("\n");
@@ -100,16 +100,16 @@ void Ball::printCubeNeighbors(const char* filename) {
         Vector3(0, 0, -1)  // mz
     };
     
-    Cube * neighborCube = nullptr;
+    Cube neighborCube;
     
     for (int i = 0; i < nextCubeId; ++i) {
-        Cube* cube = cubeMap[i];
-        fprintf(file, "%d\t", cube->getId());
+        Cube cube = cubeAt(cubeMap[i]);
+        fprintf(file, "%d\t", cube.getId());
         
         for(int j = 0 ; j < 6 ; j++) {
-        	neighborCube = cube->getNeighbor(directions[j]);
+        	neighborCube = cube.getNeighbor(directions[j]);
         	if(neighborCube)
-        	fprintf(file, "%d\t", neighborCube->getId());
+        	fprintf(file, "%d\t", neighborCube.getId());
         }
 
         fprintf(file,"\n");
@@ -124,10 +124,10 @@ void Ball::printBoundaryFaceNeighbors(const char* filename) {
     FILE* file = fopen(filename, "w");
 
     for (size_t i = 0; i < nextFaceBId; ++i) {
-        Face* face = BoundaryFaces[i];
-        fprintf(file, "%d ", face->getBId());
-        for (Face* neighborFace : face->neighbors) {
-            if (neighborFace) fprintf(file, "%d ", neighborFace->getBId());
+        Face face = faceAt(BoundaryFaces[i]);
+        fprintf(file, "%d ", face.getBId());
+        for (Slot neighborFace : store.faceNeighbors[face.getSlot()]) {
+            if (neighborFace != NoSlot) fprintf(file, "%d ", faceAt(neighborFace).getBId());
         }
         fprintf(file,"\n");
     }
@@ -150,10 +150,10 @@ void Ball::printCubeDensity(const char* filename) {
 
     // Iterate through all cubes and print their coordinates
     for (size_t i = 0; i < nextCubeId; ++i) {
-        Cube* cube = cubeMap[i];
-        if (cube) {  // Make sure the cube pointer is not null
-            const Vector3& coord = cube->getVector();  // Assuming getVector() returns a reference to the Vector3 of the cube's position
-            fprintf(file, "%d %d %d %d\n", cube->getId(), coord.x, coord.y, coord.z);
+        Cube cube = cubeAt(cubeMap[i]);
+        if (cube) {  // Make sure the cube slot is not empty
+            const Vector3& coord = cube.getVector();  // Assuming getVector() returns a reference to the Vector3 of the cube's position
+            fprintf(file, "%d %d %d %d\n", cube.getId(), coord.x, coord.y, coord.z);
         }
     }
 
@@ -168,6 +168,7 @@ void Ball::printCubeDensity(const char* filename) {
         char CDfilename[256];
 
     		
+		const std::string& name = context->params.name;
 		sprintf(Bafilename, "Boundary-%s.out", name.c_str());
 		sprintf(Cafilename, "Cubulation-%s.out", name.c_str());
 		sprintf(CDfilename, "CubeDensity-%s.out", name.c_str());
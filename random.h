@@ -76,45 +76,71 @@ public:
 
         return result_starstar;
     }
-};
 
-/*// Function to set or reset the global RNG's seed
-void setGlobalRNGSeed(uint64_t seed) {
-    static bool canSetSeed = true;
-    if (canSetSeed) {
-        // Directly initialize the static instance with a new seed
-        static Xoshiro256PlusPlus rng(seed);
-        canSetSeed = false; // Prevent further re-seeding to ensure consistent RNG behavior
-    } else {
-        // Optionally, log a warning or handle the case when an attempt is made to re-seed the RNG
+    // Equivalent to 2^128 calls of operator(): splits the period into 2^128
+    // non-overlapping streams, e.g. one per replica.
+    void jump() { jumpBy({ 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c }); }
+
+    // Equivalent to 2^192 calls of operator(): 2^64 starting points, each with
+    // room for 2^64 jump() streams.
+    void long_jump() { jumpBy({ 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 }); }
+
+private:
+    void jumpBy(const uint64_t (&poly)[4]) {
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (int i = 0; i < 4; i++) {
+            for (int b = 0; b < 64; b++) {
+                if (poly[i] & (UINT64_C(1) << b)) {
+                    t[0] ^= s[0];
+                    t[1] ^= s[1];
+                    t[2] ^= s[2];
+                    t[3] ^= s[3];
+                }
+                (*this)();
+            }
+        }
+        s[0] = t[0];
+        s[1] = t[1];
+        s[2] = t[2];
+        s[3] = t[3];
     }
-}*/
+};
 
-/*Xoshiro256PlusPlus& RNG() {
-    static Xoshiro256PlusPlus rng(getseed()); // Default initialization
-    return rng;
-}*/
 
+// Generator owned by one simulation: produces the same sequence as
+// Xoshiro256PlusPlus, but in blocks of BatchSize outputs so the hot loop only
+// reads from a buffer.
+class RandomStream {
+public:
+    static constexpr int BatchSize = 256;
 
+    explicit RandomStream(uint64_t seed = getseed()) : gen(seed) {}
 
-// Global RNG accessor (no heap allocation / indirection).
-static inline Xoshiro256PlusPlus& RNG() {
-    static Xoshiro256PlusPlus rng_instance(getseed());
-    return rng_instance;
-}
+    void reseed(uint64_t seed) { gen.reseed(seed); pos = BatchSize; }
 
+    // Unread buffered outputs are dropped, the jump starts after them.
+    void jump() { gen.jump(); pos = BatchSize; }
+    void long_jump() { gen.long_jump(); pos = BatchSize; }
 
+    uint64_t operator()() {
+        if (pos == BatchSize) refill();
+        return buffer[pos++];
+    }
+
+private:
+    Xoshiro256PlusPlus gen;
+    uint64_t buffer[BatchSize];
+    int pos = BatchSize;
 
-static inline void setGlobalRNGSeed(uint64_t seed) { RNG().reseed(seed); }
-/*// Global RNG function
-Xoshiro256PlusPlus& RNG() {
-    static Xoshiro256PlusPlus rng_instance;
-    return rng_instance;
-}*/
+    void refill() {
+        for (int i = 0; i < BatchSize; i++) buffer[i] = gen();
+        pos = 0;
+    }
+};
 
-// Function templates using the global RNG instance
-static inline uint32_t uniform_int(uint32_t range) {
-    uint32_t x = RNG()();
+// Uniform draws from a given generator (Xoshiro256PlusPlus or RandomStream)
+template<typename Generator> static inline uint32_t uniform_int(Generator& rng, uint32_t range) {
+    uint32_t x = rng();
     uint64_t m = uint64_t(x) * uint64_t(range);
     uint32_t l = uint32_t(m);
     if (l < range) {
@@ -124,7 +150,7 @@ static inline uint32_t uniform_int(uint32_t range) {
             if (t >= range) t %= range;
         }
         while (l < t) {
-            x = RNG()();
+            x = rng();
             m = uint64_t(x) * uint64_t(range);
             l = uint32_t(m);
         }
@@ -134,30 +160,35 @@ static inline uint32_t uniform_int(uint32_t range) {
 
 static inline double uint64_to_double(uint64_t x) { return (x >> 11) * (1. / (UINT64_C(1) << 53)); }
 
-static inline double uniform_real() { return uint64_to_double(RNG()()); }
+template<typename Generator> static inline double uniform_real(Generator& rng) { return uint64_to_double(rng()); }
+
+// Fill out[0..n) with uniforms in [0,1) in one go.
+template<typename Generator> static inline void uniform_real(Generator& rng, double* out, int n) {
+    for (int i = 0; i < n; i++) out[i] = uint64_to_double(rng());
+}
 
-static inline double uniform_real(double min, double max) { return min + (max - min) * uniform_real(); }
+template<typename Generator> static inline double uniform_real(Generator& rng, double min, double max) { return min + (max - min) * uniform_real(rng); }
 
-template<typename RNG> double random_normal(double mean, double sigma) {
+template<typename Generator> double random_normal(Generator& rng, double mean, double sigma) {
     const double two_pi = 2.0 * 3.14159265358979323846;
 
     double u1, u2;
     do {
-        u1 = uniform_real();
-        u2 = uniform_real();
+        u1 = uniform_real(rng);
+        u2 = uniform_real(rng);
     } while (u1 <= std::numeric_limits<double>::min());
 
     double z0 = std::sqrt(-2.0 * std::log(u1)) * std::cos(two_pi * u2);
     return z0 * sigma + mean;
 }
 
-template<typename RNG> double random_bernoulli(double probTrue) { return uniform_real() <= probTrue; }
+template<typename Generator> bool random_bernoulli(Generator& rng, double probTrue) { return uniform_real(rng) <= probTrue; }
 
-int random_choice(std::vector<double>& weights) {
+template<typename Generator> int random_choice(Generator& rng, std::vector<double>& weights) {
     double total = 0.0;
     for (auto w : weights) total += w;
     
-    double p = uniform_real(0.0, total);
+    double p = uniform_real(rng, 0.0, total);
     for (size_t i = 0; i < weights.size(); ++i) {
         p -= weights[i];
         if (p <= 0.0) return static_cast<int>(i);
@@ -0,0 +1,170 @@
+#pragma once
+#ifndef REJECTION_FREE_H
+#define REJECTION_FREE_H
+
+/*
+ * Rejection-free (n-fold way / BKL) update engine.
+ *
+ * A Metropolis step picks grow or shrink with probability 1/2, a uniform
+ * boundary face out of A, and accepts the move with min(1, moveprob(dNB)).
+ * The acceptance only depends on the move class (grow/shrink, dNB), so with
+ * n_c faces cached in class c the probability that a step changes the
+ * configuration is
+ *
+ *   Q = sum_c n_c / (2A) * min(1, moveprob_c)
+ *
+ * advanceRejectionFree() samples the class with weight n_c * min(1, moveprob_c),
+ * a uniform face of that class, and the number of Metropolis steps the move
+ * took from the geometric distribution with success probability Q. Time
+ * averages over steps are therefore the same as for the Metropolis loop.
+ *
+ * After a move only the faces whose checks can read the changed cube X are
+ * reclassified. Links always connect cubes whose coordinates differ by the
+ * link offset, and every cube a check reads lies within Chebyshev distance 2
+ * of the (possibly rotated) face's cube, which is itself at most one link
+ * away from the picked face's cube. A check that reads X therefore sits on a
+ * cube within distance 3 of X and reaches X through at most 5 links, all
+ * within distance 4 of X; the refresh region is collected by exactly that walk.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ball.h"
+
+static constexpr int MoveRegionLinks = 5;
+static constexpr int MoveRegionReach = 4;  // Chebyshev radius of the link walk
+static constexpr int MoveRegionRadius = 3; // Chebyshev radius of the refreshed cubes
+
+static inline int chebyshev(const Vector3& v) { return std::max(std::abs(v.x), std::max(std::abs(v.y), std::abs(v.z))); }
+
+
+void Ball::classifyMoveFace(Slot face) {
+	if (!isBoundarySlot(face)) {
+		buckets.set(MoveGrow, face, -1);
+		buckets.set(MoveShrink, face, -1);
+		return;
+	}
+
+	const int growNB = CheckValidGrow(faceAt(face)).first;
+	const int shrinkNB = CheckValidShrink(faceAt(face)).first;
+
+	buckets.set(MoveGrow, face, growNB == -1 ? -1 : MoveBuckets::classOf(growNB));
+	buckets.set(MoveShrink, face, shrinkNB == -1 ? -1 : MoveBuckets::classOf(shrinkNB));
+}
+
+
+void Ball::buildMoveBuckets() {
+	buckets.clear();
+	for (int i = 0; i < nextFaceBId; i++) classifyMoveFace(BoundaryFaces[i]);
+	bucketsValid = true;
+}
+
+
+void Ball::collectMoveRegion(Cube center) {
+	if (regionMark.size() < store.cubeId.size()) regionMark.resize(store.cubeId.size(), 0);
+	if (++regionEpoch == 0) {
+		std::fill(regionMark.begin(), regionMark.end(), 0);
+		regionEpoch = 1;
+	}
+
+	regionCubes.clear();
+	regionFaces.clear();
+
+	regionCubes.push_back(center.getSlot());
+	regionMark[center.getSlot()] = regionEpoch;
+
+	const Vector3 origin = center.getVector();
+	size_t begin = 0;
+	for (int depth = 0; depth < MoveRegionLinks; depth++) {
+		const size_t end = regionCubes.size();
+		for (size_t i = begin; i < end; i++) {
+			for (Slot neighbor : store.cubeNeighbors[regionCubes[i]]) {
+				if (neighbor == NoSlot || regionMark[neighbor] == regionEpoch) continue;
+				regionMark[neighbor] = regionEpoch;
+				if (chebyshev(store.cubeCoord[neighbor] - origin) <= MoveRegionReach) regionCubes.push_back(neighbor);
+			}
+		}
+		begin = end;
+	}
+
+	for (Slot cube : regionCubes) {
+		if (chebyshev(store.cubeCoord[cube] - origin) > MoveRegionRadius) continue;
+		for (Slot face : store.cubeFaces[cube]) if (face != NoSlot) regionFaces.push_back(face);
+	}
+}
+
+
+double Ball::getMoveRates(double rates[2][5]) {
+	const double norm = 0.5 / static_cast<double>(nextFaceBId);
+	const bool canGrow = hasCapacity(); // same limits as performGrow/performShrink
+	const bool canShrink = nextCubeId != 1;
+
+	double total = 0;
+	for (int cls = 0; cls < 5; cls++) {
+		const double dNB = static_cast<double>(MoveBuckets::dNBOf(cls));
+
+		const int nGrow = canGrow ? buckets.count(MoveGrow, cls) : 0;
+		const int nShrink = canShrink ? buckets.count(MoveShrink, cls) : 0;
+
+		rates[MoveGrow][cls] = nGrow ? nGrow * norm * std::min(1.0, getMoveProbGrow(dNB)) : 0;
+		rates[MoveShrink][cls] = nShrink ? nShrink * norm * std::min(1.0, getMoveProbShrink(dNB)) : 0;
+
+		total += rates[MoveGrow][cls] + rates[MoveShrink][cls];
+	}
+	return total;
+}
+
+
+// Advance the chain by the equivalent of `steps` Metropolis steps and return
+// the sum of the volume after each step (what the Metropolis loop adds to meanV).
+double Ball::advanceRejectionFree(int steps) {
+	if (!bucketsValid) buildMoveBuckets();
+
+	double sumV = 0;
+	double rates[2][5];
+
+	while (steps > 0) {
+		const double total = getMoveRates(rates);
+		if (total <= 0) { sumV += static_cast<double>(steps) * nextCubeId; break; } // frozen
+
+		// Steps until (and including) the next accepted move, geometric in total.
+		// The distribution is memoryless, so drawing afresh on every call is exact.
+		double wait = 1;
+		if (total < 1) wait += std::floor(std::log(1.0 - uniform_real(rng)) / std::log1p(-total));
+
+		if (wait > steps) { sumV += static_cast<double>(steps) * nextCubeId; break; }
+
+		sumV += (wait - 1) * nextCubeId;
+		steps -= static_cast<int>(wait);
+
+		// Choose the move class, then a uniform face of that class
+		double r = uniform_real(rng) * total;
+		int move = 0, cls = 0;
+		for (int i = 0; i < 10; i++) {
+			if (rates[i/5][i%5] <= 0) continue;
+			move = i/5; cls = i%5; // the last non-empty class also absorbs rounding at the end of the range
+			r -= rates[move][cls];
+			if (r < 0) break;
+		}
+
+		Face face = faceAt(buckets.faces[move][cls][uniform_int(rng, buckets.count(move, cls))]);
+
+		if (move == MoveGrow) {
+			growCube(CheckValidGrow(face).second);
+			collectMoveRegion(cubeAt(cubeMap[nextCubeId-1]));
+		} else {
+			const std::pair<int, Face> deltaNB = CheckValidShrink(face);
+			collectMoveRegion(deltaNB.second.getCube());
+			shrinkCube(deltaNB.second);
+		}
+		for (Slot regionFace : regionFaces) classifyMoveFace(regionFace);
+		countMetropolis(move, MoveBuckets::dNBOf(cls), true); // every event is an accepted move
+
+		sumV += nextCubeId;
+	}
+
+	return sumV;
+}
+
+
+#endif
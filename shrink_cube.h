@@ -18,16 +18,27 @@
 bool Ball:: performShrink() {
 	// Cache nextCubeId and nextFaceBId to avoid repeated member access
 	const int cachedNextCubeId = nextCubeId;
-	if(cachedNextCubeId == 1) return false;
+	countProposal(MoveShrink);
+	if(cachedNextCubeId == 1) {
+		noteRule(RuleLastCube);
+		countChecked(MoveShrink, -1);
+		return false;
+	}
 	
-	std::pair<int, Face*> deltaNB;
+	std::pair<int, Face> deltaNB;
 	
 	const int cachedNextFaceBId = nextFaceBId;
-	deltaNB = CheckValidShrink(GetBoundaryFace(uniform_int(cachedNextFaceBId)));
+	deltaNB = CheckValidShrink(GetBoundaryFace(uniform_int(rng, cachedNextFaceBId)));
+	countChecked(MoveShrink, deltaNB.first);
 	
 	if(deltaNB.first == -1) return false;
 	
-	if(getActionDiffShrink((double)deltaNB.first)) shrinkCube(deltaNB.second);	
+	if(getActionDiffShrink((double)deltaNB.first)) {
+		shrinkCube(deltaNB.second);
+		bucketsValid = false; // cached move classes are stale now
+		countMetropolis(MoveShrink, deltaNB.first, true);
+	}
+	else countMetropolis(MoveShrink, deltaNB.first, false);
 	
 	
 	return true;
@@ -35,82 +46,107 @@ bool Ball:: performShrink() {
 }
 
 		
-std::pair<int, Face*> Ball::CheckValidShrink(Face* boundaryFace) {	
-	Cube * cube = boundaryFace->getCube();
+std::pair<int, Face> Ball::CheckValidShrink(Face boundaryFace) {
+	const MoveTables& tables = moveTables();
+
+	Cube cube = boundaryFace.getCube();
+	const uint32_t mask = cube.getMask();
+	int d = Vector3::axisIndex(boundaryFace.getVector());
+
+	// ROTATE THE POINT OF VIEW If no bottom
+	if (!(mask & (1u << tables.bottomBit[d]))) {
+		noteRotated();
+		const int rotation = tables.shrinkRotation[MoveTables::gather(mask, tables.shrinkBits[d], 4)];
+		if (rotation < 0) { noteRule(RuleRotation); return std::make_pair(-1, boundaryFace); } // invalid config-->changes topology
+
+		d = tables.orthogonalAxis[d][rotation];
+		boundaryFace = cube.getFace(Vector3::axisFromIndex(d));
+	}
+
+	const uint32_t key = tables.shrinkKey(mask, d);
+	if (tables.shrink[key] == -1) noteRule(static_cast<MoveRule>(tables.shrinkRule[key]));
+	return std::make_pair(static_cast<int>(tables.shrink[key]), boundaryFace);
+}
+
+
+// Reference implementation walking the neighbour grid; CheckValidShrink gives
+// the same answer from the occupancy mask alone.
+std::pair<int, Face> Ball::CheckValidShrinkWalk(Face boundaryFace) {	
+	Cube cube = boundaryFace.getCube();
 	
-	Vector3 direction = boundaryFace->getVector();
+	Vector3 direction = boundaryFace.getVector();
 	    
     // Cache orthogonals array - reused multiple times
     auto orthogonals = direction.getOrthogonal(); // 4 orthogonal directions (no allocation)
       
-    Cube * tempCube0 = nullptr;
-    Cube * tempCube1 = nullptr;
-    Cube * tempCube2 = nullptr;
-    Cube * tempCube3 = nullptr;
+    Cube tempCube0;
+    Cube tempCube1;
+    Cube tempCube2;
+    Cube tempCube3;
 
    // ROTATE THE POINT OF VIEW If no bottom
    
-    if(!(cube->getNeighbor(direction * -1))) {
-		tempCube0 = cube->getNeighbor(orthogonals[0]);
-		tempCube1 = cube->getNeighbor(orthogonals[1]);
-		tempCube2 = cube->getNeighbor(orthogonals[2]);
-		tempCube3 = cube->getNeighbor(orthogonals[3]);
-
-		if(tempCube0 && !tempCube2) boundaryFace = cube->getFace(orthogonals[2]);
-		else if(!tempCube0 && tempCube2) boundaryFace = cube->getFace(orthogonals[0]);
-		else if(tempCube1 && !tempCube3) boundaryFace = cube->getFace(orthogonals[3]);
-		else if(!tempCube1 && tempCube3) boundaryFace = cube->getFace(orthogonals[1]);
+    if(!(cube.getNeighbor(direction * -1))) {
+		tempCube0 = cube.getNeighbor(orthogonals[0]);
+		tempCube1 = cube.getNeighbor(orthogonals[1]);
+		tempCube2 = cube.getNeighbor(orthogonals[2]);
+		tempCube3 = cube.getNeighbor(orthogonals[3]);
+
+		if(tempCube0 && !tempCube2) boundaryFace = cube.getFace(orthogonals[2]);
+		else if(!tempCube0 && tempCube2) boundaryFace = cube.getFace(orthogonals[0]);
+		else if(tempCube1 && !tempCube3) boundaryFace = cube.getFace(orthogonals[3]);
+		else if(!tempCube1 && tempCube3) boundaryFace = cube.getFace(orthogonals[1]);
 		else return std::make_pair(-1, boundaryFace); // invalid config-->changes topology
 		
-		direction = boundaryFace->getVector();
+		direction = boundaryFace.getVector();
 		orthogonals = direction.getOrthogonal(); // recompute orthogonals for new direction
     }
 	
-	//assert(cube->getNeighbor(direction * -1));
+	//assert(cube.getNeighbor(direction * -1));
     
-    Cube * sideCubes_below[4] =  {nullptr};
-	Cube * cornerCubes_below[4] =  {nullptr};
-	Cube * sideCubes_layer[4] =  {nullptr};
-	Cube * cornerCubes_layer[4] =  {nullptr};
-	Cube * sideCubes_above[4] =  {nullptr};
-	Cube * cornerCubes_above[4] =  {nullptr};
-	Cube * bottomCube = nullptr;
+    Cube sideCubes_below[4];
+	Cube cornerCubes_below[4];
+	Cube sideCubes_layer[4];
+	Cube cornerCubes_layer[4];
+	Cube sideCubes_above[4];
+	Cube cornerCubes_above[4];
+	Cube bottomCube;
     
-	Cube * tempCube = nullptr;
+	Cube tempCube;
 	
 	for(int i = 0 ; i < 4 ; i++) {
 			
-		sideCubes_layer[i] = cube->getNeighbor(orthogonals[i]); 
+		sideCubes_layer[i] = cube.getNeighbor(orthogonals[i]); 
 		
-		cornerCubes_layer[i] = cube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]);
+		cornerCubes_layer[i] = cube.getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]);
 
-		sideCubes_above[i] = cube->getNeighbor(orthogonals[i]+direction);
-		cornerCubes_above[i] = cube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+direction);
+		sideCubes_above[i] = cube.getNeighbor(orthogonals[i]+direction);
+		cornerCubes_above[i] = cube.getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+direction);
 		
-		sideCubes_below[i] = cube->getNeighbor(orthogonals[i] + direction * -1); 
-		cornerCubes_below[i] = cube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+ direction * -1);
+		sideCubes_below[i] = cube.getNeighbor(orthogonals[i] + direction * -1); 
+		cornerCubes_below[i] = cube.getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+ direction * -1);
 		
-		sideCubes_above[i] = cube->getNeighbor(orthogonals[i]+direction);
-		cornerCubes_above[i] = cube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+direction);
+		sideCubes_above[i] = cube.getNeighbor(orthogonals[i]+direction);
+		cornerCubes_above[i] = cube.getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+direction);
 			
 	}
 	/*
 	printf(" in Shrink CHECK  \n");
-	printf("Cube ID : %d \t below id: %d \n",cube->getId(),cube->getNeighbor(direction * -1)->getId());
+	printf("Cube ID : %d \t below id: %d \n",cube.getId(),cube.getNeighbor(direction * -1).getId());
 		
 	for(int i = 0 ; i < 4 ; i++) {
-   		if(sideCubes_below[i]) printf("sb %d\t%d\n",i,sideCubes_below[i]->getId());
-   		if(sideCubes_layer[i]) printf("sl %d\t%d\n",i,sideCubes_layer[i]->getId());
-   		if(sideCubes_above[i]) printf("sa %d\t%d\n",i,sideCubes_above[i]->getId());
-   		if(cornerCubes_below[i]) printf("cb %d\t%d\n",i,cornerCubes_below[i]->getId());
-   		if(cornerCubes_layer[i]) printf("cl %d\t%d\n",i,cornerCubes_layer[i]->getId());
-   		if(cornerCubes_above[i]) printf("ca %d\t%d\n",i,cornerCubes_above[i]->getId());
+   		if(sideCubes_below[i]) printf("sb %d\t%d\n",i,sideCubes_below[i].getId());
+   		if(sideCubes_layer[i]) printf("sl %d\t%d\n",i,sideCubes_layer[i].getId());
+   		if(sideCubes_above[i]) printf("sa %d\t%d\n",i,sideCubes_above[i].getId());
+   		if(cornerCubes_below[i]) printf("cb %d\t%d\n",i,cornerCubes_below[i].getId());
+   		if(cornerCubes_layer[i]) printf("cl %d\t%d\n",i,cornerCubes_layer[i].getId());
+   		if(cornerCubes_above[i]) printf("ca %d\t%d\n",i,cornerCubes_above[i].getId());
    	}
 
 	*/
 	
 	
-	bottomCube = cube->getNeighbor(direction * -1);
+	bottomCube = cube.getNeighbor(direction * -1);
 	
 	
 	int sumACA = 0;
@@ -134,88 +170,63 @@ std::pair<int, Face*> Ball::CheckValidShrink(Face* boundaryFace) {
 
 
 
-void Ball::shrinkCube(Face* boundaryFace) {
-//	printf(" ################################################# \n");
-//	printf(" ################### START SHRINK ############## \n");
-//	printf(" ################################################# \n");
-				
-				
-	Cube * cube = boundaryFace->getCube();
-	Vector3 direction = boundaryFace->getVector();
-	// Cache orthogonals array - reused multiple times
-	const auto orthogonals = direction.getOrthogonal(); // 4 orthogonal directions (no allocation)
-    
-    Cube * tempCube0 = nullptr;
-    Cube * tempCube1 = nullptr;
-    Cube * tempCube2 = nullptr;
-    Cube * tempCube3 = nullptr;
-
-/*    if(!(cube->getNeighbor(direction * -1))) {
-		tempCube0 = cube->getNeighbor(orthogonals[0]);
-		tempCube1 = cube->getNeighbor(orthogonals[1]);
-		tempCube2 = cube->getNeighbor(orthogonals[2]);
-		tempCube3 = cube->getNeighbor(orthogonals[3]);
-		
-		if(tempCube0 && !tempCube2) direction = orthogonals[2];
-		else if(!tempCube0 && tempCube2) direction = orthogonals[0];
-		else if(tempCube1 && !tempCube3) direction = orthogonals[3];
-		else if(!tempCube1 && tempCube3) direction = orthogonals[1]; 
-
-		orthogonals = direction.getOrthogonal();
-		boundaryFace = cube->getFace(direction);
-    	
-    }
- 
-	assert(cube->getNeighbor(direction * -1));
- */   
+void Ball::shrinkCube(Face boundaryFace) {
+	dispatchDirection(Vector3::axisIndex(boundaryFace.getVector()), [&](auto direction) { shrinkCubeAlong<decltype(direction)::value>(boundaryFace); });
+}
+
+// Remove the cube behind boundaryFace, which points along D and has a cube below
+template<int D> void Ball::shrinkCubeAlong(Face boundaryFace) {
+	static constexpr DirectionFrame F = makeDirectionFrame(D);
+
+	Cube cube = boundaryFace.getCube();
       
-    Cube * sideCubes_below[4] =  {nullptr};
-	Cube * cornerCubes_below[4] =  {nullptr};
-	Cube * sideCubes_layer[4] =  {nullptr};
-	Cube * cornerCubes_layer[4] =  {nullptr};
-	Cube * sideCubes_above[4] =  {nullptr};
-	Cube * cornerCubes_above[4] =  {nullptr};
-	Cube * bottomCube = nullptr;
-    Face * bottomFace = nullptr;
+    Cube sideCubes_below[4];
+	Cube cornerCubes_below[4];
+	Cube sideCubes_layer[4];
+	Cube cornerCubes_layer[4];
+	Cube sideCubes_above[4];
+	Cube cornerCubes_above[4];
+	Cube bottomCube;
+    Face bottomFace;
 	
-	Face * adjacentFaces[4] = {nullptr};
-	Face * sideFaces[4] = {nullptr};
+	Face adjacentFaces[4];
+	Face sideFaces[4];
 	
-	bottomFace = cube->getFace(direction * -1);
-	bottomCube = cube->getNeighbor(direction * -1);
+	bottomFace = cube.getFaceAt(F.downAxis);
+	bottomCube = cube.getNeighbor(F.below);
 	
 	for(int i = 0 ; i < 4 ; i++) {
-		sideCubes_layer[i] = cube->getNeighbor(orthogonals[i]); 
-		cornerCubes_layer[i] = cube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]);
+		sideCubes_layer[i] = cube.getNeighbor(F.side[i]); 
+		cornerCubes_layer[i] = cube.getNeighbor(F.corner[i]);
 
-		sideCubes_above[i] = cube->getNeighbor(orthogonals[i]+direction);
-		cornerCubes_above[i] = cube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+direction);
+		sideCubes_above[i] = cube.getNeighbor(F.sideUp[i]);
+		cornerCubes_above[i] = cube.getNeighbor(F.cornerUp[i]);
 		
-		sideCubes_below[i] = cube->getNeighbor(orthogonals[i] + direction * -1); 
-		cornerCubes_below[i] = cube->getNeighbor(orthogonals[i]+orthogonals[(i+1)%4]+ direction * -1);
+		sideCubes_below[i] = cube.getNeighbor(F.sideDown[i]); 
+		cornerCubes_below[i] = cube.getNeighbor(F.cornerDown[i]);
 			
-		sideFaces[i] = cube->getFace(orthogonals[i]);
+		sideFaces[i] = cube.getFaceAt(F.sideAxis[i]);
 	}
 	
-	for(int i = 0 ; i < 4 ; i++) adjacentFaces[i] = boundaryFace->getAdjacent(orthogonals[i]);
+	for(int i = 0 ; i < 4 ; i++) adjacentFaces[i] = boundaryFace.getAdjacentAt(F.sideAxis[i]);
 	
 	for(int i = 0 ; i < 4 ; i++) {
 		
-		if(sideCubes_above[i]) unsetCubeCubeNeighbor(cube,sideCubes_above[i],orthogonals[i]+direction);
-		if(cornerCubes_above[i]) unsetCubeCubeNeighbor(cube,cornerCubes_above[i],orthogonals[i]+orthogonals[(i+1)%4]+direction);
+		if(sideCubes_above[i]) unsetCubeCubeNeighbor(cube,sideCubes_above[i],F.sideUp[i]);
+		if(cornerCubes_above[i]) unsetCubeCubeNeighbor(cube,cornerCubes_above[i],F.cornerUp[i]);
 		
-		if(sideCubes_layer[i]) unsetCubeFaceNeighbor(cube,sideCubes_layer[i],orthogonals[i]);
-		else unsetNewCubeBFacePair(cube,sideFaces[i],orthogonals[i]);
+		if(sideCubes_layer[i]) unsetCubeFaceNeighbor(cube,sideCubes_layer[i],F.sideAxis[i]);
+		else unsetNewCubeBFacePair(cube,sideFaces[i],F.sideAxis[i]);
 
-		if(cornerCubes_layer[i]) unsetCubeCubeNeighbor(cube,cornerCubes_layer[i],orthogonals[i]+orthogonals[(i+1)%4]);
+		if(cornerCubes_layer[i]) unsetCubeCubeNeighbor(cube,cornerCubes_layer[i],F.corner[i]);
 
-		if(sideCubes_below[i]) unsetCubeCubeNeighbor(cube,sideCubes_below[i],orthogonals[i]+direction*-1);
-		if(cornerCubes_below[i]) unsetCubeCubeNeighbor(cube,cornerCubes_below[i],orthogonals[i]+orthogonals[(i+1)%4]+direction*-1);
+		if(sideCubes_below[i]) unsetCubeCubeNeighbor(cube,sideCubes_below[i],F.sideDown[i]);
+		if(cornerCubes_below[i]) unsetCubeCubeNeighbor(cube,cornerCubes_below[i],F.cornerDown[i]);
 
 	}
 	
 	
-	unsetCubeFaceNeighbor(cube,bottomCube,direction*-1);
+	unsetCubeFaceNeighbor(cube,bottomCube,F.downAxis);
 	
 	RemoveFaceBoundary(boundaryFace);
 	
@@ -225,41 +236,42 @@ void Ball::shrinkCube(Face* boundaryFace) {
 			
 			deleteFace(sideFaces[i]);
 		}
-		else RestoreFaceBoundary(sideFaces[i],orthogonals[i] * -1); 
+		else RestoreFaceBoundary(sideFaces[i],Vector3::axisFromIndex(F.sideAxis[(i+2)%4])); 
 		
 	}
-	RestoreFaceBoundary(bottomFace,direction);
+	RestoreFaceBoundary(bottomFace,Vector3::axisFromIndex(D));
 
 	
 	for(int i = 0 ; i <4 ; i++) {
 	
-		if(sideCubes_above[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],direction,direction * -1);
-		else if(sideCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],direction,orthogonals[i]*-1);
+		if(sideCubes_above[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],F.upAxis,F.downAxis);
+		else if(sideCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],adjacentFaces[i],F.upAxis,F.sideAxis[(i+2)%4]);
 
-		if(sideCubes_layer[i] && sideCubes_layer[(i+1)%4]) setFaceFaceAdjacent(sideFaces[i],sideFaces[(i+1)%4],orthogonals[(i+1)%4],orthogonals[i]);
+		if(sideCubes_layer[i] && sideCubes_layer[(i+1)%4]) setFaceFaceAdjacent(sideFaces[i],sideFaces[(i+1)%4],F.sideAxis[(i+1)%4],F.sideAxis[i]);
 			
 		else if(sideCubes_layer[i]) {
-			if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],cornerCubes_layer[i]->getFace(orthogonals[i]*-1),orthogonals[(i+1)%4],orthogonals[(i+1)%4]*-1);		
-			else setFaceFaceAdjacent(sideFaces[i],sideCubes_layer[i]->getFace(orthogonals[(i+1)%4]),orthogonals[(i+1)%4],orthogonals[i]*-1);
+			if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[i],cornerCubes_layer[i].getFaceAt(F.sideAxis[(i+2)%4]),F.sideAxis[(i+1)%4],F.sideAxis[(i+3)%4]);		
+			else setFaceFaceAdjacent(sideFaces[i],sideCubes_layer[i].getFaceAt(F.sideAxis[(i+1)%4]),F.sideAxis[(i+1)%4],F.sideAxis[(i+2)%4]);
 			
 		}
 		else if(sideCubes_layer[(i+1)%4]) {
 			
-			if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[(i+1)%4],cornerCubes_layer[i]->getFace(orthogonals[(i+1)%4]*-1),orthogonals[i],orthogonals[i]*-1);			
-			else setFaceFaceAdjacent(sideFaces[(i+1)%4],sideCubes_layer[(i+1)%4]->getFace(orthogonals[i]),orthogonals[i],orthogonals[(i+1)%4]*-1);
+			if(cornerCubes_layer[i]) setFaceFaceAdjacent(sideFaces[(i+1)%4],cornerCubes_layer[i].getFaceAt(F.sideAxis[(i+3)%4]),F.sideAxis[i],F.sideAxis[(i+2)%4]);			
+			else setFaceFaceAdjacent(sideFaces[(i+1)%4],sideCubes_layer[(i+1)%4].getFaceAt(F.sideAxis[i]),F.sideAxis[i],F.sideAxis[(i+3)%4]);
 
 		}
 		else {;}	
 	
-		if(sideCubes_layer[i]) setFaceFaceAdjacent(bottomFace,sideFaces[i],orthogonals[i], direction*-1);
-		else if(sideCubes_below[i]) setFaceFaceAdjacent(bottomFace,sideCubes_below[i]->getFace(direction),orthogonals[i], orthogonals[i] * -1);
-		else setFaceFaceAdjacent(bottomFace,bottomCube->getFace(orthogonals[i]),orthogonals[i], direction);
+		if(sideCubes_layer[i]) setFaceFaceAdjacent(bottomFace,sideFaces[i],F.sideAxis[i],F.downAxis);
+		else if(sideCubes_below[i]) setFaceFaceAdjacent(bottomFace,sideCubes_below[i].getFaceAt(F.upAxis),F.sideAxis[i],F.sideAxis[(i+2)%4]);
+		else setFaceFaceAdjacent(bottomFace,bottomCube.getFaceAt(F.sideAxis[i]),F.sideAxis[i],F.upAxis);
 
 	}
 
 	
 	deleteFace(boundaryFace);
 
+	removeCoordinate(cube.getVector());
 	deleteCube(cube);
 	
 }
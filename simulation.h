@@ -0,0 +1,172 @@
+#pragma once
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <chrono>
+#include "ball.h"
+
+// One single-ball run on a given ball: grow to V (unless it is grown already: restart
+// from a checkpoint, warm start from another run or a start shape file), thermalize with tuneV() (or
+// equilibrate with tuneCouplings() first, tunemode 1), write the configs.
+// With targeterror the run equilibrates first, keeps the couplings fixed while it measures
+// and stops once the error target is met; walltime stops it in any mode.
+// All state lives in the context and the ball, so several runs can share a process.
+// Returns the couplings the ball ended with (tuned by tuneV / tuneCouplings).
+Couplings runSimulation(SimulationContext& context, Ball& ball, bool grown) {
+	const SimulationParams& params = context.params;
+
+	const auto started = std::chrono::steady_clock::now();
+	auto overBudget = [&]() {
+		return params.walltime > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() >= params.walltime;
+	};
+
+    printf("###### START THERMAL: ######\n");
+    
+    
+  	if(!grown) {
+		{
+		PhaseTimer growth(context.phases, PhaseGrowth);
+	  	for(int i = 0 ; i < params.V; i++) {
+			ball.performGrow();
+			ball.measure();
+	    }
+		}
+	    
+		PhaseTimer equilibration(context.phases, PhaseEquilibration);
+	    for(int i = 0 ; i < params.V; i++) {
+			if(0.5 > uniform_real(ball.getRNG())) ball.performGrow();
+				else ball.performShrink();	
+			ball.measure();
+	    }
+    }
+    
+	context.window = 10;
+    
+    // Cache window division result
+    const int window = context.window;
+    const int stepsPerWindow = int(params.steps/window);
+
+    // The moves of one thermal cycle; also sums V and A over the cycle for tuneCouplings()
+    auto sweep = [&]() {
+		context.cycleV = context.cycleA = 0;
+		context.cycleSteps = 0;
+		for(int j = 0 ; j < stepsPerWindow; j++) {
+			double meanV = 0;
+			if(params.rejectionfree) meanV += ball.advanceRejectionFree(window);
+			else for(int k = 0 ; k < window ; k++) {
+				if(0.5 > uniform_real(ball.getRNG())) ball.performGrow();
+				else ball.performShrink();
+				meanV+=ball.getNextCubeId();
+			}
+			context.meanV = meanV;
+			context.cycleV += meanV;
+			context.cycleA += static_cast<double>(ball.getBNextFaceId()) * window;
+			context.cycleSteps += window;
+		}
+    };
+
+	// Adaptive tuning: equilibrate until the couplings hold V (and A) before measuring anything.
+	// Precision-targeted runs with tunemode 0 do the same with tuneV() steps.
+	if((params.tunemode == 1 || params.targeterror > 0) && !context.tune.converged) {
+		PhaseTimer equilibration(context.phases, PhaseEquilibration);
+		const int maxCycles = params.tunecycles > 0 ? params.tunecycles : params.thermal;
+		while(context.tune.cycles < maxCycles && !overBudget()) {
+			sweep();
+			if(params.tunemode == 1) {
+				if(ball.tuneCouplings()) break;
+				continue;
+			}
+			ball.tuneV();
+			if(params.tuneAV) ball.tuneA();
+			if(ball.holdsTargets()) break;
+		}
+		
+		if(context.tune.converged) printf("###### EQUILIBRATED after %d cycles: lambda %g alpha %g ######\n", context.tune.cycles, ball.lambda, ball.alpha);
+		else printf("###### NOT EQUILIBRATED after %d cycles (tunecycles or walltime), measuring anyway ######\n", context.tune.cycles);
+		context.tune.converged = 1;
+	}
+    
+    const char* stopped = nullptr; // why the thermal cycles ended early
+    
+    for(int i = context.cycle ; i < params.thermal; i++) {
+		{
+		PhaseTimer thermal(context.phases, PhaseThermal);
+		sweep();
+		}
+		
+		{
+		PhaseTimer output(context.phases, PhaseOutput);
+		context.errors.add(ball.measure());
+		if(params.rhist && context.radialHistogramFile()) ball.writeRadialHistogram(context.radialHistogramFile());
+		}
+		
+		// The adaptive controller has frozen the couplings by now; a precision-targeted
+		// run freezes them too, so every measurement samples the same ensemble
+		if(params.tunemode == 0 && params.targeterror <= 0) {
+		PhaseTimer tuning(context.phases, PhaseTuning);
+		ball.tuneV();
+		if(params.tuneAV) ball.tuneA();
+		}
+		
+		context.cycle = i + 1;
+		if(params.compactevery > 0 && context.cycle % params.compactevery == 0) {
+			PhaseTimer compact(context.phases, PhaseCompact);
+			ball.compactStorage();
+		}
+		if(params.checkpoint > 0 && !params.outname.empty() && context.cycle % params.checkpoint == 0) {
+			PhaseTimer output(context.phases, PhaseOutput);
+			ball.saveState(params.outname);
+		}
+		if(params.statsevery > 0 && context.cycle % params.statsevery == 0 && context.statsFile()) {
+			writeStats(context.statsFile(), context.cycle, ball.getNextCubeId(), context.phases, ball.getMoveStats());
+		}
+		if(params.errorsevery > 0 && context.cycle % params.errorsevery == 0 && context.errorsFile()) context.errors.write(context.errorsFile(), context.cycle);
+		
+		if(params.targeterror > 0 && context.errors.reached(params.targetmask, params.targeterror, params.targetmin)) { stopped = "precision target reached"; break; }
+		if(overBudget()) { stopped = "walltime used up"; break; }
+    }
+    
+    if(stopped) printf("###### STOPPED after %d thermal cycles: %s (relative error %g) ######\n", context.cycle, stopped, context.errors.worstRelativeError(params.targetmask));
+
+    printf("###### ERRORS (binning / jackknife over the thermal cycles of this run): ######\n");
+    context.errors.print();
+
+	{
+	PhaseTimer output(context.phases, PhaseOutput);
+    if(!params.outname.empty()) ball.saveState(params.outname);
+
+
+    printf("###### PRINT CONFIGS: ######\n");
+    
+    ball.printConfigs();
+	}
+
+	// Final line with the output phase complete
+	if(params.statsevery > 0 && context.statsFile()) writeStats(context.statsFile(), context.cycle, ball.getNextCubeId(), context.phases, ball.getMoveStats());
+
+	return Couplings{ball.lambda, ball.alpha, ball.epsilon};
+}
+
+// Single-ball run of main.cpp: a new ball, or with fromfile the checkpoint in inname;
+// false if that checkpoint cannot be loaded
+bool runSimulation(SimulationContext& context) {
+	const SimulationParams& params = context.params;
+	const bool restart = params.fromfile && !params.inname.empty();
+
+	printf(restart ? "######## Load a Ball ############\n" : "######## Create a Ball ############\n");
+
+	if (restart) {
+		bool loaded;
+		Ball ball(context, params.inname, loaded);
+		if (!loaded) return false;
+		runSimulation(context, ball, true);
+		return true;
+	}
+
+    Ball ball(context);
+    runSimulation(context, ball, params.startShape());
+    return true;
+}
+
+
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef STATS_H
+#define STATS_H
+
+/*
+ * Move statistics and per-phase wall time.
+ *
+ * The move counters are compiled in only with -DMOVE_STATS=1; otherwise every
+ * count*() call is an empty `if constexpr` and the Metropolis loop is the same
+ * code as without them. The phase timers are a clock read per phase and always on.
+ * With statsevery > 0 both are appended to stats-<name>.out every statsevery
+ * thermal cycles, cumulative since the start of the run.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include "lookup.h"
+#include "buckets.h"
+
+#ifndef MOVE_STATS
+#define MOVE_STATS 0
+#endif
+
+static constexpr bool MoveStatsEnabled = MOVE_STATS;
+
+// Per move type (MoveGrow, MoveShrink)
+struct MoveStats {
+	long proposals[2] = {};
+	long rotated[2] = {};            // proposals checked from a rotated face
+	long rejected[2][RuleCount] = {}; // by the rule that made the move invalid
+	long metropolis[2] = {};         // valid, rejected by the Metropolis test
+	long accepted[2][5] = {};        // by dNB class, MoveBuckets::classOf
+
+	void add(const MoveStats& other) {
+		for (int move = 0; move < 2; move++) {
+			proposals[move] += other.proposals[move];
+			rotated[move] += other.rotated[move];
+			metropolis[move] += other.metropolis[move];
+			for (int rule = 0; rule < RuleCount; rule++) rejected[move][rule] += other.rejected[move][rule];
+			for (int cls = 0; cls < 5; cls++) accepted[move][cls] += other.accepted[move][cls];
+		}
+	}
+};
+
+
+enum Phase { PhaseGrowth, PhaseEquilibration, PhaseThermal, PhaseTuning, PhaseOutput, PhaseCompact, PhaseCount };
+
+static const char* const PhaseNames[PhaseCount] = {"growth", "equilibration", "thermal", "tuning", "output", "compact"};
+
+struct PhaseTimes {
+	double seconds[PhaseCount] = {};
+};
+
+// Adds its lifetime to one phase
+class PhaseTimer {
+public:
+	PhaseTimer(PhaseTimes& times, Phase phase) : times(times), phase(phase), start(std::chrono::steady_clock::now()) {}
+	~PhaseTimer() { times.seconds[phase] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+private:
+	PhaseTimes& times;
+	Phase phase;
+	std::chrono::steady_clock::time_point start;
+};
+
+
+static void writeStatsHeader(FILE* out) {
+	if (!MoveStatsEnabled) fprintf(out, "# move counters compiled out (build with -DMOVE_STATS=1), only the phase times are measured\n");
+	fprintf(out, "# cycle\tV");
+	for (int phase = 0; phase < PhaseCount; phase++) fprintf(out, "\t%s[s]", PhaseNames[phase]);
+	for (const char* move : {"grow", "shrink"}) {
+		fprintf(out, "\t%s.proposals\t%s.rotated", move, move);
+		for (int rule = 1; rule < RuleCount; rule++) fprintf(out, "\t%s.%s", move, MoveRuleNames[rule]);
+		fprintf(out, "\t%s.metropolis", move);
+		for (int cls = 0; cls < 5; cls++) fprintf(out, "\t%s.dNB%+d", move, MoveBuckets::dNBOf(cls));
+	}
+	fprintf(out, "\n");
+}
+
+static void writeStats(FILE* out, int cycle, int V, const PhaseTimes& times, const MoveStats& stats) {
+	fprintf(out, "%d\t%d", cycle, V);
+	for (int phase = 0; phase < PhaseCount; phase++) fprintf(out, "\t%.3f", times.seconds[phase]);
+	for (int move = 0; move < 2; move++) {
+		fprintf(out, "\t%ld\t%ld", stats.proposals[move], stats.rotated[move]);
+		for (int rule = 1; rule < RuleCount; rule++) fprintf(out, "\t%ld", stats.rejected[move][rule]);
+		fprintf(out, "\t%ld", stats.metropolis[move]);
+		for (int cls = 0; cls < 5; cls++) fprintf(out, "\t%ld", stats.accepted[move][cls]);
+	}
+	fprintf(out, "\n");
+	fflush(out);
+}
+
+
+#endif
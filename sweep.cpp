@@ -0,0 +1,29 @@
+// Parameter sweep in one process:  sweep <sweep file>
+//
+// The sweep file is a config file whose lambda, alpha, kappa, V, A and seed
+// may be lists (-0.4,0,0.4) or ranges (-2:0.1:2); every combination runs as
+// its own simulation on a work-stealing pool of `workers` threads (default:
+// all hardware threads), see sweep.h. Per-point outputs are named as for
+// main.cpp with the point values appended to `name`; the summary goes to
+// sweep-<name>.out.
+//
+// Build: g++ -std=c++17 -O3 -pthread sweep.cpp -I. -o sweep
+
+#include "globals.h"
+#include "sweep.h"
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <sweep file>\n", argv[0]);
+		return 1;
+	}
+
+	printf("###### USING SWEEP FILE: %s\n", argv[1]);
+
+	ConfigReader cfr;
+	cfr.read(argv[1]);
+	runSweep(cfr);
+
+	printf("###### FINITO ######\n");
+	return 0;
+}
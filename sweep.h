@@ -0,0 +1,417 @@
+#pragma once
+#ifndef SWEEP_H
+#define SWEEP_H
+
+/*
+ * Parameter sweeps inside one process (sweep.cpp).
+ *
+ * A sweep file is a config file in which lambda, alpha, kappa, V, A and seed
+ * may hold a list (-0.4,0,0.4) or an inclusive range first:step:last (as in
+ * seq). Every combination is one point: a copy of the config with these values
+ * and name, inname, outname suffixed by the values, e.g. name L-0.4-1000. The
+ * points run as ordinary single-ball runs (runSimulation, or runTempering with
+ * replicas > 1), so each writes its usual cube-<name>.out etc.
+ *
+ * The points are ordered by estimated work (2 V + thermal * steps moves, largest
+ * first) and dealt round robin to the queues of a fixed set of workers (key
+ * workers, default one per hardware thread). A worker takes its own largest
+ * point; once its queue is empty it steals the largest point left in any other
+ * queue, so points that finish early (targeterror, walltime) do not leave cores
+ * idle. One line per finished point goes to sweep-<name>.out.
+ *
+ * Every point runs with its own seed, the config seed mixed with the point's
+ * index in the expansion (point 0 keeps it), so points that share a seed line
+ * do not repeat each other's random numbers.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config.h"
+#include "params.h"
+#include "simulation.h"
+#include "tempering.h"
+
+// Keys that may hold lists or ranges, in the order they appear in point names
+static const char* const SweepKeys[] = {"lambda", "alpha", "kappa", "V", "A", "seed"};
+
+
+// Per-worker queues of task ranks (0 = most work); run() returns once every task is done.
+// A job can make further tasks ready with push() (warm starts wait for their source).
+class WorkStealingPool {
+public:
+	explicit WorkStealingPool(int n) : queues(std::max(1, n)) {
+		for (std::unique_ptr<Queue>& q : queues) q.reset(new Queue());
+	}
+
+	int size() const { return static_cast<int>(queues.size()); }
+
+	void run(int tasks, const std::function<void(int task, int worker)>& job) {
+		std::vector<int> ready(tasks);
+		for (int t = 0; t < tasks; t++) ready[t] = t;
+		run(tasks, ready, job);
+	}
+
+	// tasks in total, of which `ready` can start right away
+	void run(int tasks, const std::vector<int>& ready, const std::function<void(int task, int worker)>& job) {
+		remaining = tasks;
+		for (size_t k = 0; k < ready.size(); k++) queues[k % size()]->ranks.push_back(ready[k]);
+
+		std::vector<std::thread> workers;
+		for (int w = 0; w < size(); w++) {
+			workers.emplace_back([this, w, &job] {
+				int task;
+				while (next(w, task)) {
+					job(task, w);
+					std::lock_guard<std::mutex> lock(idleMutex);
+					remaining--;
+					generation++;
+					idle.notify_all();
+				}
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+	}
+
+	// Queue a task that became ready at the front of the worker's own queue
+	void push(int worker, int task) {
+		{
+			std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+			queues[worker]->ranks.push_front(task);
+		}
+		std::lock_guard<std::mutex> lock(idleMutex);
+		generation++;
+		idle.notify_all();
+	}
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<int> ranks; // ascending, except for pushed tasks at the front
+	};
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	std::mutex idleMutex;
+	std::condition_variable idle;
+	int remaining = 0;      // tasks not finished
+	unsigned generation = 0; // bumped by every push and every finished task
+
+	// Own front first, else the smallest front rank of the other queues; waits while
+	// nothing is queued but tasks are still running
+	bool next(int w, int& task) {
+		while (true) {
+			unsigned seen;
+			{
+				std::lock_guard<std::mutex> lock(idleMutex);
+				if (remaining == 0) return false;
+				seen = generation;
+			}
+			if (take(w, task)) return true;
+
+			std::unique_lock<std::mutex> lock(idleMutex);
+			idle.wait(lock, [&] { return remaining == 0 || generation != seen; });
+		}
+	}
+
+	bool take(int w, int& task) {
+		{
+			std::lock_guard<std::mutex> lock(queues[w]->mutex);
+			if (!queues[w]->ranks.empty()) {
+				task = queues[w]->ranks.front();
+				queues[w]->ranks.pop_front();
+				return true;
+			}
+		}
+		while (true) {
+			int victim = -1, best = 0;
+			for (int v = 0; v < size(); v++) {
+				if (v == w) continue;
+				std::lock_guard<std::mutex> lock(queues[v]->mutex);
+				if (!queues[v]->ranks.empty() && (victim < 0 || queues[v]->ranks.front() < best)) {
+					victim = v;
+					best = queues[v]->ranks.front();
+				}
+			}
+			if (victim < 0) return false;
+
+			std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+			if (queues[victim]->ranks.empty()) continue; // taken meanwhile, look again
+			task = queues[victim]->ranks.front();
+			queues[victim]->ranks.pop_front();
+			return true;
+		}
+	}
+};
+
+
+struct SweepPoint {
+	ConfigReader config; // the sweep file with this point's values
+	std::string suffix;  // values of the swept keys joined by '-'
+	double work = 0;     // estimated moves
+	int index = 0;       // position in the expansion, before sorting by work
+	int seed = 0;        // seed the point runs with, see sweepSeed()
+	int source = -1;     // warm start: the point whose final ball this one starts from
+};
+
+// Values of a list (a,b,c) or an inclusive range (first:step:last); anything else is a single value
+static std::vector<std::string> sweepValues(const std::string& text) {
+	std::vector<std::string> values;
+	std::stringstream items(text);
+	std::string item;
+	if (text.find(',') != std::string::npos) {
+		while (std::getline(items, item, ',')) if (!item.empty()) values.push_back(item);
+		return values;
+	}
+
+	double range[3];
+	int parts = 0;
+	while (parts < 3 && std::getline(items, item, ':')) range[parts++] = std::stod(item);
+	if (parts < 3 || range[1] == 0) return {text};
+
+	const long count = static_cast<long>(std::floor((range[2] - range[0]) / range[1] + 1e-9)) + 1;
+	for (long k = 0; k < count; k++) {
+		double x = range[0] + k * range[1];
+		x = std::round(x * 1e9) / 1e9; // 0.30000000000000004 -> 0.3
+		char value[64];
+		snprintf(value, sizeof(value), "%.10g", x + 0.0); // + 0.0 turns -0 into 0
+		values.push_back(value);
+	}
+	return values;
+}
+
+// Seed of the point with the given index: the config seed for point 0, for the others
+// the seed and index mixed, so that no two points draw the same random numbers
+static int sweepSeed(int seed, int index) {
+	if (index == 0) return seed;
+	SplitMix mixer(static_cast<uint64_t>(static_cast<uint32_t>(seed)) << 32 | static_cast<uint32_t>(index));
+	return static_cast<int>(mixer() >> 33);
+}
+
+// "conf.dat" + "-0.4-1000" -> "conf-0.4-1000.dat"
+static std::string sweepFileName(const std::string& file, const std::string& suffix) {
+	const size_t dot = file.find_last_of('.');
+	if (dot == std::string::npos || dot == 0) return file + "-" + suffix;
+	return file.substr(0, dot) + "-" + suffix + file.substr(dot);
+}
+
+// Every combination of the swept values, largest estimated work first
+static std::vector<SweepPoint> expandSweep(ConfigReader& sweep) {
+	std::vector<SweepPoint> points(1);
+	points[0].config = sweep;
+	for (const char* key : SweepKeys) {
+		if (!sweep.has(key)) continue;
+		const std::string text = sweep.getString(key);
+		const std::vector<std::string> values = sweepValues(text);
+		const bool swept = values.size() > 1 || values[0] != text;
+
+		std::vector<SweepPoint> next;
+		for (const SweepPoint& point : points) {
+			for (const std::string& value : values) {
+				SweepPoint p = point;
+				p.config.set(key, value);
+				if (swept) p.suffix += (p.suffix.empty() ? "" : "-") + value;
+				next.push_back(p);
+			}
+		}
+		points.swap(next);
+	}
+
+	for (size_t k = 0; k < points.size(); k++) {
+		SweepPoint& point = points[k];
+		ConfigReader& cfr = point.config;
+		point.index = static_cast<int>(k);
+		point.seed = sweepSeed(cfr.getInt("seed"), point.index);
+		if (!point.suffix.empty()) {
+			cfr.set("name", cfr.getString("name") + "-" + point.suffix);
+			for (const char* key : {"inname", "outname"}) {
+				if (cfr.has(key)) cfr.set(key, sweepFileName(cfr.getString(key), point.suffix));
+			}
+		}
+		const double restart = cfr.getInt("fromfile", 0) ? 0 : 2.0 * cfr.getInt("V");
+		point.work = restart + static_cast<double>(cfr.getInt("thermal")) * cfr.getInt("steps") * std::max(1, cfr.getInt("replicas", 1));
+	}
+	std::stable_sort(points.begin(), points.end(), [](const SweepPoint& a, const SweepPoint& b) { return a.work > b.work; });
+	return points;
+}
+
+
+// Warm starts: the points that share V, A and seed form a chain ordered by lambda,
+// alpha, kappa. The chain is cut into `cold` segments; the middle point of each
+// segment is grown from scratch, every other point starts from the final ball of
+// its neighbour towards that middle point. Tempering points and restarts from a
+// checkpoint always start cold.
+static void planWarmStarts(std::vector<SweepPoint>& points, int cold) {
+	std::map<std::string, std::vector<int>> groups;
+	for (int k = 0; k < static_cast<int>(points.size()); k++) {
+		ConfigReader& cfr = points[k].config;
+		if (cfr.getInt("replicas", 0) > 1 || cfr.getInt("fromfile", 0)) continue;
+		groups[cfr.getString("V") + " " + cfr.getString("A") + " " + cfr.getString("seed")].push_back(k);
+	}
+
+	for (auto& group : groups) {
+		std::vector<int>& chain = group.second;
+		auto couplings = [&](int k) {
+			ConfigReader& cfr = points[k].config;
+			return std::array<double, 3>{cfr.getDouble("lambda"), cfr.getDouble("alpha"), cfr.getDouble("kappa", 0)};
+		};
+		std::stable_sort(chain.begin(), chain.end(), [&](int a, int b) { return couplings(a) < couplings(b); });
+
+		const int n = static_cast<int>(chain.size());
+		const int segments = std::max(1, std::min(cold, n));
+		for (int j = 0; j < segments; j++) {
+			const int lo = j * n / segments, hi = (j + 1) * n / segments;
+			const int middle = (lo + hi) / 2;
+			for (int i = lo; i < middle; i++) points[chain[i]].source = chain[i + 1];
+			for (int i = middle + 1; i < hi; i++) points[chain[i]].source = chain[i - 1];
+		}
+	}
+}
+
+static void writeSweepHeader(FILE* out) {
+	fprintf(out, "# point\tname\tlambda\talpha\tV\tA\tseed\tcycles\tlambda.end\talpha.end");
+	for (int i = 0; i < ObservableErrors::Count; i++) fprintf(out, "\t%s\t%s.err", ObservableErrors::name(i), ObservableErrors::name(i));
+	fprintf(out, "\tseconds\tworker\tfrom\n");
+	fflush(out);
+}
+
+// Runs every point of the sweep file on a work-stealing pool and writes sweep-<name>.out
+void runSweep(ConfigReader& sweep) {
+	std::vector<SweepPoint> points = expandSweep(sweep);
+	const int hardware = std::max(1u, std::thread::hardware_concurrency());
+	const int workers = std::max(1, std::min(static_cast<int>(points.size()), sweep.getInt("workers", hardware)));
+
+	FILE* summary = fopen(("sweep-" + sweep.getString("name") + ".out").c_str(), "a");
+	if (!summary) { perror("Failed to open file for output"); return; }
+	fseek(summary, 0, SEEK_END);
+	if (ftell(summary) == 0) writeSweepHeader(summary);
+
+	const int n = static_cast<int>(points.size());
+	const int warm = sweep.getInt("warmstart", 0);
+	if (warm > 0) planWarmStarts(points, warm);
+
+	// Points that can start now, and per point the ones waiting for its final ball.
+	// Tempering points bring their own thread pool; they run one after another
+	// once the pool is done, so the machine is not oversubscribed.
+	std::vector<int> ready, tempering;
+	std::vector<std::vector<int>> warmed(n);
+	for (int k = 0; k < n; k++) {
+		if (points[k].config.getInt("replicas", 0) > 1) tempering.push_back(k);
+		else if (points[k].source < 0) ready.push_back(k);
+		else warmed[points[k].source].push_back(k);
+	}
+	std::vector<std::unique_ptr<Ball>> finished(n); // kept until every waiting point has copied it
+	std::vector<int> copiesLeft(n, 0);
+	std::mutex ballsMutex;
+
+	printf("######## SWEEP: %d points (%zu cold starts) on %d workers, then %zu tempering points ############\n", n, ready.size(), workers, tempering.size());
+	std::mutex summaryMutex;
+	const auto started = std::chrono::steady_clock::now();
+
+	// Start shape files, read once for all the points that use them (nullptr if unreadable)
+	std::map<std::string, std::shared_ptr<const std::vector<Vector3>>> shapes;
+	std::mutex shapesMutex;
+
+	WorkStealingPool pool(workers);
+	// One point; worker -1 for the tempering points run outside the pool
+	auto runPoint = [&](int k, int worker) {
+		SimulationParams pointParams = SimulationParams::fromConfig(points[k].config);
+		pointParams.seed = points[k].seed;
+		SimulationContext context(pointParams);
+		const SimulationParams& params = context.params;
+		int from = points[k].source;
+		if (from >= 0) {
+			std::lock_guard<std::mutex> lock(ballsMutex);
+			if (!finished[from]) from = -1; // the source failed, start cold
+		}
+
+		// A point whose start cannot be built is skipped; the other points go on
+		const bool restart = params.replicas <= 1 && params.fromfile && !params.inname.empty();
+		if (from < 0 && !restart) {
+			if (params.startShape()) {
+				std::lock_guard<std::mutex> lock(shapesMutex);
+				const std::string file = !params.startdensity.empty() ? params.startdensity : params.startmask;
+				auto it = shapes.find(file);
+				if (it == shapes.end()) it = shapes.emplace(file, readStartShape(params)).first;
+				context.startCubes = it->second;
+			}
+			if ((params.startShape() && !context.startCubes) || !prepareStart(context)) {
+				printf("######## SWEEP POINT %s skipped: its start cannot be built ############\n", params.name.c_str());
+				for (int next : warmed[k]) pool.push(worker, next);
+				return;
+			}
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		Couplings end = {params.lambda, params.alpha, params.epsilon}; // fixed on a tempering ladder
+		if (params.replicas > 1) {
+			if (!runTempering(context)) {
+				printf("######## SWEEP POINT %s failed ############\n", params.name.c_str());
+				return;
+			}
+		}
+		else {
+			std::unique_ptr<Ball> ball;
+			bool grown = from >= 0;
+			if (from >= 0) {
+				printf("######## Warm start %s from %s ############\n", params.name.c_str(), points[from].config.getString("name").c_str());
+				ball.reset(new Ball(context, *finished[from]));
+				std::lock_guard<std::mutex> lock(ballsMutex);
+				if (--copiesLeft[from] == 0) finished[from].reset();
+			}
+			else if (restart) {
+				bool loaded;
+				ball.reset(new Ball(context, params.inname, loaded));
+				if (!loaded) {
+					printf("######## SWEEP POINT %s skipped: cannot load %s ############\n", params.name.c_str(), params.inname.c_str());
+					for (int next : warmed[k]) pool.push(worker, next);
+					return;
+				}
+				grown = true;
+			}
+			else {
+				ball.reset(new Ball(context));
+				grown = params.startShape();
+			}
+
+			end = runSimulation(context, *ball, grown);
+
+			if (!warmed[k].empty()) {
+				std::lock_guard<std::mutex> lock(ballsMutex);
+				copiesLeft[k] = static_cast<int>(warmed[k].size());
+				finished[k] = std::move(ball);
+			}
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		{
+		std::lock_guard<std::mutex> lock(summaryMutex);
+		fprintf(summary, "%d\t%s\t%.10g\t%.10g\t%d\t%d\t%d\t%d\t%.10g\t%.10g", k, params.name.c_str(), params.lambda, params.alpha,
+		        params.V, params.A, params.seed, context.cycle, end.lambda, end.alpha);
+		for (const BinningSeries& s : context.errors.series) fprintf(summary, "\t%.10g\t%.4g", s.mean(), s.error());
+		fprintf(summary, "\t%.1f\t%d\t%s\n", seconds, worker, from >= 0 ? points[from].config.getString("name").c_str() : "-");
+		fflush(summary);
+		printf("######## SWEEP POINT %s done after %.1f s on worker %d ############\n", params.name.c_str(), seconds, worker);
+		}
+
+		for (int next : warmed[k]) pool.push(worker, next);
+	};
+	pool.run(n - static_cast<int>(tempering.size()), ready, runPoint);
+	for (int k : tempering) runPoint(k, -1);
+
+	fclose(summary);
+	printf("######## SWEEP DONE: %d points in %.1f s ############\n", n,
+	       std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+}
+
+#endif
@@ -0,0 +1,343 @@
+#pragma once
+#ifndef TEMPERING_H
+#define TEMPERING_H
+
+/*
+ * Parallel tempering (replica exchange) over a ladder of couplings.
+ *
+ * Every replica is a Ball with its own couplings and its own random stream,
+ * jump()ed ahead from the config seed so the streams never overlap and the
+ * result does not depend on the number of threads. The replicas are advanced
+ * on a fixed pool of worker threads. Between sweeps neighbouring
+ * rungs r, r+1 of the ladder try to exchange their configurations: with the
+ * weight exp(-S) of the action used by getMoveProbGrow/getMoveProbShrink the
+ * swap of configurations a, b is accepted with
+ *
+ *   min(1, exp(S_r(a) + S_r+1(b) - S_r(b) - S_r+1(a)))
+ *
+ * Instead of copying cubulations the two balls exchange their couplings.
+ * Even and odd pairs are tried alternately.
+ *
+ * Round trips are counted per replica as the number of exchange rounds between
+ * two arrivals at rung 0 with a visit of the last rung in between. The fraction
+ * of replicas at each rung that last visited rung 0 ("up" fraction) is also
+ * recorded; a good ladder has it falling linearly from 1 to 0.
+ */
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ball.h"
+
+
+// Fixed set of threads; run() executes task(k) on worker k and waits for all of them.
+class ThreadPool {
+public:
+	explicit ThreadPool(int n) {
+		for (int k = 0; k < n; k++) workers.emplace_back(&ThreadPool::loop, this, k);
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		start.notify_all();
+		for (std::thread& worker : workers) worker.join();
+	}
+
+	int size() const { return static_cast<int>(workers.size()); }
+
+	void run(const std::function<void(int)>& job) {
+		std::unique_lock<std::mutex> lock(mutex);
+		task = &job;
+		pending = size();
+		generation++;
+		start.notify_all();
+		done.wait(lock, [this] { return pending == 0; });
+		task = nullptr;
+	}
+
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable start, done;
+	const std::function<void(int)>* task = nullptr;
+	unsigned generation = 0;
+	int pending = 0;
+	bool stop = false;
+
+	void loop(int k) {
+		unsigned seen = 0;
+		while (true) {
+			const std::function<void(int)>* job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				start.wait(lock, [&] { return stop || generation != seen; });
+				if (stop) return;
+				seen = generation;
+				job = task;
+			}
+			(*job)(k);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (--pending == 0) done.notify_one();
+			}
+		}
+	}
+};
+
+
+class ParallelTempering {
+public:
+	ParallelTempering(const std::vector<Couplings>& rungs, int threads, SimulationContext& context)
+		: ladder(rungs), rng(context.params.seed), pool(std::max(1, std::min(threads, static_cast<int>(rungs.size())))) {
+		const int n = static_cast<int>(ladder.size());
+
+		for (int r = 0; r < n; r++) {
+			replicas.emplace_back(new Ball(context));
+			for (int j = 0; j <= r; j++) replicas[r]->getRNG().jump(); // swaps use the unjumped stream
+			replicas[r]->setCouplings(ladder[r]);
+			replicaAt.push_back(r);
+			rungOf.push_back(r);
+		}
+		attempts.assign(n, 0);
+		accepts.assign(n, 0);
+		direction.assign(n, 0);
+		tripStart.assign(n, -1);
+		upCount.assign(n, 0);
+		visitCount.assign(n, 0);
+		roundTrips.assign(n, 0);
+		roundTripRounds.assign(n, 0);
+	}
+
+	int size() const { return static_cast<int>(ladder.size()); }
+
+	Ball& getReplica(int rung) { return *replicas[replicaAt[rung]]; }
+
+	// Same start as a single run: grow to the target volume, then random moves.
+	// With fromOne only the first replica grows, the others start from copies of it.
+	void grow(int volume, bool fromOne) {
+		auto growBall = [volume](Ball& ball) {
+			for (int i = 0; i < volume; i++) ball.performGrow();
+			for (int i = 0; i < volume; i++) {
+				if (0.5 > uniform_real(ball.getRNG())) ball.performGrow();
+				else ball.performShrink();
+			}
+		};
+		if (!fromOne) {
+			forEachReplica(growBall);
+			return;
+		}
+		const Ball& first = *replicas[0];
+		growBall(*replicas[0]);
+		forEachReplica([&first](Ball& ball) { ball.copyCubulation(first); });
+	}
+
+	void sweep(int steps, bool rejectionFree) {
+		forEachReplica([steps, rejectionFree](Ball& ball) {
+			if (rejectionFree) ball.advanceRejectionFree(steps);
+			else for (int k = 0; k < steps; k++) {
+				if (0.5 > uniform_real(ball.getRNG())) ball.performGrow();
+				else ball.performShrink();
+			}
+		});
+	}
+
+	void compact() { forEachReplica([](Ball& ball) { ball.compactStorage(); }); }
+
+	MoveStats moveStats() {
+		MoveStats total;
+		for (const std::unique_ptr<Ball>& ball : replicas) total.add(ball->getMoveStats());
+		return total;
+	}
+
+	// One round of swap attempts between neighbouring rungs (even or odd pairs).
+	void exchange() {
+		for (int r = rounds % 2; r + 1 < size(); r += 2) {
+			Ball& a = *replicas[replicaAt[r]];
+			Ball& b = *replicas[replicaAt[r+1]];
+
+			const double logRatio = a.getAction(ladder[r]) + b.getAction(ladder[r+1])
+			                      - b.getAction(ladder[r]) - a.getAction(ladder[r+1]);
+
+			attempts[r]++;
+			if (logRatio >= 0 || std::exp(logRatio) > uniform_real(rng)) {
+				accepts[r]++;
+				a.setCouplings(ladder[r+1]);
+				b.setCouplings(ladder[r]);
+				std::swap(replicaAt[r], replicaAt[r+1]);
+				rungOf[replicaAt[r]] = r;
+				rungOf[replicaAt[r+1]] = r+1;
+			}
+		}
+		rounds++;
+		updateRoundTrips();
+	}
+
+	void measure(std::vector<FILE*>& out) {
+		for (int r = 0; r < size(); r++) getReplica(r).measure(out[r]);
+	}
+
+	void measure(std::vector<std::unique_ptr<ObservableWriter>>& out) {
+		for (int r = 0; r < size(); r++) out[r]->write(getReplica(r).getObservables());
+	}
+
+	void printStats(FILE* out) {
+		fprintf(out, "# pair\tlambda\talpha\tlambda'\talpha'\tattempts\taccepted\trate\n");
+		for (int r = 0; r + 1 < size(); r++) {
+			fprintf(out, "%d\t%g\t%g\t%g\t%g\t%ld\t%ld\t%g\n", r, ladder[r].lambda, ladder[r].alpha,
+			        ladder[r+1].lambda, ladder[r+1].alpha, attempts[r], accepts[r],
+			        attempts[r] ? static_cast<double>(accepts[r]) / attempts[r] : 0.0);
+		}
+
+		fprintf(out, "# rung\tlambda\talpha\tup fraction\n");
+		for (int r = 0; r < size(); r++) {
+			fprintf(out, "%d\t%g\t%g\t%g\n", r, ladder[r].lambda, ladder[r].alpha,
+			        visitCount[r] ? static_cast<double>(upCount[r]) / visitCount[r] : 0.0);
+		}
+
+		long trips = 0;
+		double tripRounds = 0;
+		for (int k = 0; k < size(); k++) { trips += roundTrips[k]; tripRounds += roundTripRounds[k]; }
+		fprintf(out, "# round trips: %ld  mean rounds per trip: %g  exchange rounds: %ld\n",
+		        trips, trips ? tripRounds / trips : 0.0, rounds);
+	}
+
+private:
+	std::vector<Couplings> ladder;
+	RandomStream rng; // swap decisions
+	std::vector<std::unique_ptr<Ball>> replicas;
+	std::vector<int> replicaAt; // rung -> replica
+	std::vector<int> rungOf;    // replica -> rung
+
+	std::vector<long> attempts, accepts; // per pair (r, r+1)
+	long rounds = 0;
+
+	std::vector<int> direction;   // per replica: +1 last end visited was rung 0, -1 the last rung, 0 none yet
+	std::vector<long> tripStart;  // round at which the current trip started at rung 0
+	std::vector<long> upCount, visitCount; // per rung
+	std::vector<long> roundTrips;         // per replica
+	std::vector<double> roundTripRounds;
+
+	ThreadPool pool;
+
+	// Replica k always runs on thread k % threads.
+	void forEachReplica(const std::function<void(Ball&)>& job) {
+		const int threads = pool.size();
+		pool.run([&](int t) {
+			for (int k = t; k < size(); k += threads) job(*replicas[k]);
+		});
+	}
+
+	void updateRoundTrips() {
+		const int top = size() - 1;
+		for (int k = 0; k < size(); k++) {
+			if (rungOf[k] == 0 && direction[k] != 1) {
+				if (direction[k] == -1 && tripStart[k] >= 0) {
+					roundTrips[k]++;
+					roundTripRounds[k] += rounds - tripStart[k];
+				}
+				tripStart[k] = rounds;
+				direction[k] = 1;
+			}
+			else if (rungOf[k] == top && direction[k] != -1) direction[k] = -1;
+		}
+		for (int r = 0; r < size(); r++) {
+			const int d = direction[replicaAt[r]];
+			if (d == 0) continue;
+			visitCount[r]++;
+			if (d == 1) upCount[r]++;
+		}
+	}
+};
+
+
+// Tempering run, used by main when replicas > 1. The ladder interpolates
+// linearly from (lambda, alpha) to (lambdaend, alphaend). False (reported) if the
+// start cannot be built or an output file cannot be opened or written.
+bool runTempering(SimulationContext& context) {
+	const SimulationParams& params = context.params;
+	const int replicas = params.replicas;
+	if (!prepareStart(context)) return false; // the start shape is read once for all replicas
+
+	std::vector<Couplings> ladder(replicas);
+	for (int r = 0; r < replicas; r++) {
+		const double t = static_cast<double>(r) / (replicas - 1);
+		ladder[r] = Couplings{params.lambda + t*(params.lambdaend - params.lambda),
+		                      params.alpha + t*(params.alphaend - params.alpha), params.epsilon};
+	}
+
+	printf("######## Create %d replicas on %d threads ############\n", replicas, std::min(params.threads, replicas));
+	ParallelTempering pt(ladder, params.threads, context);
+
+	// Text (cube-<name>-<r>.out) or binary (cube-<name>-<r>.bin) observables per rung
+	std::vector<FILE*> out;
+	std::vector<std::unique_ptr<ObservableWriter>> binaryOut;
+	for (int r = 0; r < replicas; r++) {
+		char filename[256];
+		if (params.binaryout) {
+			sprintf(filename, "cube-%s-%d.bin", params.name.c_str(), r);
+			binaryOut.emplace_back(new ObservableWriter());
+			if (!binaryOut[r]->open(filename, params.toText())) return false; // the writers close themselves
+			continue;
+		}
+		sprintf(filename, "cube-%s-%d.out", params.name.c_str(), r);
+		out.push_back(fopen(filename, "a"));
+		if (!out[r]) {
+			perror("Failed to open file for output");
+			for (int q = 0; q < r; q++) fclose(out[q]);
+			return false;
+		}
+		setvbuf(out[r], nullptr, _IOFBF, 1 << 20);
+	}
+
+	printf("###### START THERMAL: ######\n");
+
+	{
+		PhaseTimer growth(context.phases, PhaseGrowth);
+		if (!params.startShape()) pt.grow(params.V, params.clonestart);
+	}
+
+	// Couplings stay fixed on the ladder: no tuneV/tuneA while exchanging.
+	for (int i = 0; i < params.thermal; i++) {
+		{
+			PhaseTimer thermal(context.phases, PhaseThermal);
+			for (int done = 0; done < params.steps; done += params.swapsteps) {
+				pt.sweep(std::min(params.swapsteps, params.steps - done), params.rejectionfree);
+				pt.exchange();
+			}
+		}
+		{
+			PhaseTimer output(context.phases, PhaseOutput);
+			if (params.binaryout) pt.measure(binaryOut);
+			else pt.measure(out);
+		}
+		if (params.compactevery > 0 && (i + 1) % params.compactevery == 0) {
+			PhaseTimer compact(context.phases, PhaseCompact);
+			pt.compact();
+		}
+		// Move counts summed over the replicas, V of rung 0
+		if (params.statsevery > 0 && (i + 1) % params.statsevery == 0 && context.statsFile()) {
+			writeStats(context.statsFile(), i + 1, pt.getReplica(0).getNextCubeId(), context.phases, pt.moveStats());
+		}
+	}
+
+	bool written = true;
+	for (FILE* f : out) written = (fclose(f) == 0) && written;
+	for (std::unique_ptr<ObservableWriter>& writer : binaryOut) written = writer->close() && written;
+	if (!written) printf("Writing the observables of %s failed\n", params.name.c_str());
+
+	char filename[256];
+	sprintf(filename, "tempering-%s.out", params.name.c_str());
+	FILE* stats = fopen(filename, "w");
+	if (stats) { pt.printStats(stats); fclose(stats); }
+	pt.printStats(stdout);
+	return written;
+}
+
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef TUNE_H
+#define TUNE_H
+
+/*
+ * Adaptive coupling tuning (tunemode 1), used by Ball::tuneCouplings() in mc.h.
+ *
+ * Each thermal cycle gives the relative error e = (target - mean) / target of
+ * the cycle mean of V (or A). The coupling follows a PI controller in velocity
+ * form,
+ *
+ *   delta = -gain * (e + tuneprop * (e - e_prev)),
+ *
+ * whose gain decays as tunegain / (1 + k) with the number k of sign changes of
+ * e (Kesten's rule for Robbins-Monro steps): far from the target the steps keep
+ * their size, once the coupling oscillates around it they shrink and the noise
+ * averages out. The volume answers a coupling change only after some cycles,
+ * the proportional term damps the overshoot this lag would cause.
+ *
+ * Tuning is done when, over the last tunehold cycles, the mean of e is within
+ * tunetol and the two halves of the window differ by less than tunetol / 2
+ * (the volume is not drifting any more). steady() applies the drift half of the
+ * test alone to an observable without a target.
+ *
+ * Plain data, so it goes into checkpoints as it is.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr int TuneWindowMax = 64; // largest tunehold
+
+struct CouplingController {
+	int signChanges = 0;
+	int count = 0;             // errors recorded
+	double lastError = 0;
+	double recent[TuneWindowMax] = {}; // last errors, recent[count % TuneWindowMax] is the oldest
+
+	// Coupling change for the relative error e; a step never exceeds maxStep
+	double step(double error, double gain0, double prop, double tol, double maxStep) {
+		if (count == 0) lastError = error; // no difference term on the first cycle
+		if (error * lastError < 0 && std::min(std::abs(error), std::abs(lastError)) > tol) signChanges++;
+		const double gain = gain0 / (1 + signChanges);
+		const double delta = gain * (error + prop * (error - lastError));
+		lastError = error;
+		return -std::max(-maxStep, std::min(maxStep, delta));
+	}
+
+	// Record one cycle, true once the window of the last `hold` errors is on target
+	bool holds(double error, double tol, int hold) {
+		recent[count++ % TuneWindowMax] = error;
+		double mean, drift;
+		if (!window(hold, mean, drift)) return false;
+		return std::abs(mean) < tol && std::abs(drift) < tol / 2;
+	}
+
+	// Same window on the cycle means themselves, for an observable without a target:
+	// true once the halves differ by less than tol / 2 relative
+	bool steady(double value, double tol, int hold) {
+		recent[count++ % TuneWindowMax] = value;
+		double mean, drift;
+		if (!window(hold, mean, drift)) return false;
+		return std::abs(drift) < tol / 2 * std::abs(mean);
+	}
+
+private:
+	// Mean of the last `hold` values and the difference of their newer and older half
+	bool window(int hold, double& mean, double& drift) const {
+		hold = std::max(2, std::min(hold, TuneWindowMax));
+		if (count < hold) return false;
+
+		double older = 0, newer = 0;
+		for (int k = 0; k < hold; k++) {
+			const double e = recent[(count - 1 - k) % TuneWindowMax];
+			if (k < hold / 2) newer += e;
+			else older += e;
+		}
+		mean = (older + newer) / hold;
+		drift = newer / (hold / 2) - older / (hold - hold / 2);
+		return true;
+	}
+};
+
+struct TuneState {
+	CouplingController volume; // lambda towards V
+	CouplingController area;   // alpha towards A (tuneAV 1)
+	int cycles = 0;            // equilibration cycles done
+	int converged = 0;         // 1 once the couplings are frozen
+};
+
+#endif